@@ -0,0 +1,178 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "benchmark.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QtEndian>
+
+
+namespace Benchmark {
+namespace {
+
+const int TABLE_DESCRIPTOR_LENGTH = 32;
+const int TABLE_LAST_UPDATE_OFFSET = 1;
+const int TABLE_RECORDS_COUNT_OFFSET = 4;
+const int TABLE_HEADER_LENGTH_OFFSET = 8;
+const int RECORD_LENGTH_OFFSET = 10;
+const int CODEPAGE_OFFSET = 29;
+const int FIELD_DESCRIPTOR_LENGTH = 32;
+const int FIELD_NAME_LENGTH = 10;
+const int FIELD_TYPE_OFFSET = 11;
+const int FIELD_OFFSET_OFFSET = 12;
+const int FIELD_LENGTH_OFFSET = 16;
+const int FIELD_PRECISION_OFFSET = 17;
+const int TERMINATOR_LENGTH = 1;
+const int DBC_LENGTH = 263;
+
+const quint8 CODEPAGE_WINDOWS_ANSI_LATIN_1 = 0x03;
+const char FIELD_DESCRIPTOR_TERMINATOR = 0x0D;
+const char END_OF_FILE_MARK = 0x1A;
+
+
+QString dataDirPath()
+{
+    return QString(QLatin1String("%1/qdbf-benchmark-%2")).arg(QDir::tempPath()).arg(QCoreApplication::applicationPid());
+}
+
+} // namespace
+
+
+bool createDataDir()
+{
+    return QDir().mkpath(dataDirPath());
+}
+
+
+void removeDataDir()
+{
+    QDir dir(dataDirPath());
+    const auto &fileNames = dir.entryList(QDir::Files);
+    for (auto i = 0; i < fileNames.size(); ++i) {
+        dir.remove(fileNames.at(i));
+    }
+    QDir().rmdir(dataDirPath());
+}
+
+
+QString dataPath(const QString &fileName)
+{
+    return QString(QLatin1String("%1/%2")).arg(dataDirPath(), fileName);
+}
+
+
+bool writeFile(const QString &fileName, const QByteArray &data)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+
+bool writeTable(const QString &fileName, quint8 version, const QVector<Field> &fields,
+                int recordsCount, const RecordWriter &writer)
+{
+    auto recordLength = 1;
+    for (auto i = 0; i < fields.size(); ++i) {
+        recordLength += fields.at(i).length;
+    }
+
+    const auto dbc = (0x30 == version || 0x31 == version);
+    const auto fieldDescriptorsLength = fields.size() * FIELD_DESCRIPTOR_LENGTH;
+    const auto headerLength = TABLE_DESCRIPTOR_LENGTH + fieldDescriptorsLength + TERMINATOR_LENGTH +
+                              (dbc ? DBC_LENGTH : 0);
+
+    QByteArray header(headerLength, '\0');
+    auto data = reinterpret_cast<uchar *>(header.data());
+    const auto &today = QDate::currentDate();
+    data[0] = version;
+    data[TABLE_LAST_UPDATE_OFFSET] = uchar(today.year() % 100);
+    data[TABLE_LAST_UPDATE_OFFSET + 1] = uchar(today.month());
+    data[TABLE_LAST_UPDATE_OFFSET + 2] = uchar(today.day());
+    qToLittleEndian<quint32>(quint32(recordsCount), data + TABLE_RECORDS_COUNT_OFFSET);
+    qToLittleEndian<quint16>(quint16(headerLength), data + TABLE_HEADER_LENGTH_OFFSET);
+    qToLittleEndian<quint16>(quint16(recordLength), data + RECORD_LENGTH_OFFSET);
+    data[CODEPAGE_OFFSET] = CODEPAGE_WINDOWS_ANSI_LATIN_1;
+
+    auto fieldOffset = 1;
+    for (auto i = 0; i < fields.size(); ++i) {
+        const auto &field = fields.at(i);
+        const auto descriptor = data + TABLE_DESCRIPTOR_LENGTH + i * FIELD_DESCRIPTOR_LENGTH;
+        memcpy(descriptor, field.name.constData(), size_t(qMin(field.name.size(), FIELD_NAME_LENGTH)));
+        descriptor[FIELD_TYPE_OFFSET] = uchar(field.type);
+        qToLittleEndian<quint32>(quint32(fieldOffset), descriptor + FIELD_OFFSET_OFFSET);
+        descriptor[FIELD_LENGTH_OFFSET] = uchar(field.length);
+        descriptor[FIELD_PRECISION_OFFSET] = uchar(field.precision);
+        fieldOffset += field.length;
+    }
+    data[TABLE_DESCRIPTOR_LENGTH + fieldDescriptorsLength] = FIELD_DESCRIPTOR_TERMINATOR;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(header) != header.size()) {
+        return false;
+    }
+
+    QByteArray record(recordLength, ' ');
+    for (auto row = 0; row < recordsCount; ++row) {
+        record.fill(' ');
+        writer(row, record.data() + 1);
+        if (file.write(record) != record.size()) {
+            return false;
+        }
+    }
+
+    return file.putChar(END_OF_FILE_MARK);
+}
+
+
+qint64 bestOf(int runs, const std::function<bool ()> &run)
+{
+    qint64 best = -1;
+    QElapsedTimer timer;
+    for (auto i = 0; i < runs; ++i) {
+        timer.start();
+        if (!run()) {
+            return -1;
+        }
+        const auto nsecs = timer.nsecsElapsed();
+        if (best < 0 || nsecs < best) {
+            best = nsecs;
+        }
+    }
+
+    return best;
+}
+
+
+void report(const QString &name, double value, const char *unit)
+{
+    printf("%-48s %14.2f %s\n", qPrintable(name), value, unit);
+    fflush(stdout);
+}
+
+} // namespace Benchmark
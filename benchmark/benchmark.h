@@ -0,0 +1,65 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+
+namespace Benchmark {
+
+struct Field
+{
+    QByteArray name;
+    char type;
+    int length;
+    int precision;
+};
+
+// Fills the fields of one record, the deletion flag is written by writeTable()
+typedef std::function<void (int row, char *data)> RecordWriter;
+
+bool createDataDir();
+void removeDataDir();
+QString dataPath(const QString &fileName);
+
+bool writeFile(const QString &fileName, const QByteArray &data);
+bool writeTable(const QString &fileName, quint8 version, const QVector<Field> &fields,
+                int recordsCount, const RecordWriter &writer);
+
+// Returns the shortest of the runs in nanoseconds, or -1 if a run failed
+qint64 bestOf(int runs, const std::function<bool ()> &run);
+
+void report(const QString &name, double value, const char *unit);
+
+bool memoBenchmark();
+bool numberBenchmark();
+bool openBenchmark();
+
+} // namespace Benchmark
+
+#endif // BENCHMARK_H
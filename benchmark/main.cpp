@@ -0,0 +1,60 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QStringList>
+
+#include "benchmark.h"
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    // Runs the benchmarks named on the command line, or all of them
+    const auto &arguments = a.arguments();
+    const auto selected = [&arguments](const char *name) {
+        return arguments.size() < 2 || arguments.contains(QLatin1String(name));
+    };
+
+    if (!Benchmark::createDataDir()) {
+        fprintf(stderr, "Cannot create the benchmark data directory\n");
+        return 1;
+    }
+
+    auto result = 0;
+    const auto run = [&](const char *name, bool (*benchmark)()) {
+        if (selected(name) && !benchmark()) {
+            fprintf(stderr, "The %s benchmark failed\n", name);
+            result = 1;
+        }
+    };
+
+    run("memo", Benchmark::memoBenchmark);
+    run("number", Benchmark::numberBenchmark);
+    run("open", Benchmark::openBenchmark);
+
+    Benchmark::removeDataDir();
+    return result;
+}
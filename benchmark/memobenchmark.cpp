@@ -0,0 +1,143 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "benchmark.h"
+
+#include <cstring>
+
+#include <QFile>
+#include <QtEndian>
+
+#include "qdbftable.h"
+
+using namespace QDbf;
+
+
+namespace Benchmark {
+namespace {
+
+const int RUNS = 3;
+const int MEMO_BLOCK_LENGTH = 512;
+const qint64 MEMO_DATA_LENGTH = 32 * 1024 * 1024;
+const int MIN_RECORDS_COUNT = 16;
+const int MEMO_INDEX_LENGTH = 10;
+
+const int MEMO_LENGTHS[] = { 256, 4 * 1024, 64 * 1024, 1024 * 1024 };
+const int MEMO_LENGTHS_COUNT = int(sizeof(MEMO_LENGTHS) / sizeof(MEMO_LENGTHS[0]));
+
+
+// Writes a dBase III table with a single memo field and a .dbt file
+// where every record refers to its own memo of the given length
+bool writeMemoTable(const QString &baseName, int memoLength, int recordsCount)
+{
+    const auto memoBlocks = (memoLength + 2 + MEMO_BLOCK_LENGTH - 1) / MEMO_BLOCK_LENGTH;
+
+    QByteArray memo(memoBlocks * MEMO_BLOCK_LENGTH, '\0');
+    for (auto i = 0; i < memoLength; ++i) {
+        memo[i] = char('a' + i % 26);
+    }
+    memo[memoLength] = 0x1A;
+    memo[memoLength + 1] = 0x1A;
+
+    QByteArray header(MEMO_BLOCK_LENGTH, '\0');
+    qToBigEndian<quint32>(quint32(1 + recordsCount * memoBlocks), reinterpret_cast<uchar *>(header.data()));
+
+    QFile memoFile(dataPath(baseName + QLatin1String(".dbt")));
+    if (!memoFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || memoFile.write(header) != header.size()) {
+        return false;
+    }
+
+    for (auto row = 0; row < recordsCount; ++row) {
+        if (memoFile.write(memo) != memo.size()) {
+            return false;
+        }
+    }
+    memoFile.close();
+
+    QVector<Field> fields;
+    fields.append(Field{ "NOTES", 'M', MEMO_INDEX_LENGTH, 0 });
+    const auto writer = [memoBlocks](int row, char *data) {
+        const auto &index = QByteArray::number(1 + row * memoBlocks).rightJustified(MEMO_INDEX_LENGTH, ' ');
+        memcpy(data, index.constData(), MEMO_INDEX_LENGTH);
+    };
+
+    return writeTable(dataPath(baseName + QLatin1String(".dbf")), 0x83, fields, recordsCount, writer);
+}
+
+
+bool readMemos(const QString &fileName, QDbfTable::OpenMode openMode, qint64 expectedLength)
+{
+    QDbfTable table;
+    if (!table.open(fileName, openMode)) {
+        return false;
+    }
+
+    // Every memo has to come from the file
+    table.setMemoCacheSize(0);
+
+    qint64 length = 0;
+    while (table.next()) {
+        length += table.value(0).toString().size();
+    }
+
+    return length == expectedLength;
+}
+
+} // namespace
+
+
+bool memoBenchmark()
+{
+    for (auto i = 0; i < MEMO_LENGTHS_COUNT; ++i) {
+        const auto memoLength = MEMO_LENGTHS[i];
+        const auto recordsCount = int(qMax<qint64>(MIN_RECORDS_COUNT, MEMO_DATA_LENGTH / memoLength));
+        const auto &baseName = QString(QLatin1String("memo%1")).arg(memoLength);
+        if (!writeMemoTable(baseName, memoLength, recordsCount)) {
+            return false;
+        }
+
+        const auto &fileName = dataPath(baseName + QLatin1String(".dbf"));
+        const auto expectedLength = qint64(memoLength) * recordsCount;
+
+        const QDbfTable::OpenMode openModes[] = { QDbfTable::ReadOnly, QDbfTable::MappedReadOnly };
+        const char *const openModeNames[] = { "read", "mapped" };
+        for (auto j = 0; j < 2; ++j) {
+            const auto nsecs = bestOf(RUNS, [&]() {
+                return readMemos(fileName, openModes[j], expectedLength);
+            });
+            if (nsecs < 0) {
+                return false;
+            }
+
+            const auto &name = QString(QLatin1String("memo/%1/%2 bytes")).arg(QLatin1String(openModeNames[j])).arg(memoLength);
+            report(name, double(nsecs) / 1000 / recordsCount, "us/memo");
+            report(name, double(expectedLength) * 1000 / nsecs, "MB/s");
+        }
+
+        QFile::remove(fileName);
+        QFile::remove(dataPath(baseName + QLatin1String(".dbt")));
+    }
+
+    return true;
+}
+
+} // namespace Benchmark
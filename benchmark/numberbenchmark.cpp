@@ -0,0 +1,214 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "benchmark.h"
+
+#include <cstring>
+
+#include <QVariant>
+
+#include "qdbfdecoder_p.h"
+#include "qdbfrecord.h"
+#include "qdbftable.h"
+
+using namespace QDbf;
+
+
+namespace Benchmark {
+namespace {
+
+const int RUNS = 3;
+const int NUMERALS_COUNT = 1000000;
+const int NUMERAL_LENGTH = 14;
+const int MAX_PRECISION = 5;
+const int RECORDS_COUNT = 100000;
+
+const quint32 POWERS_OF_TEN[] = { 1, 10, 100, 1000, 10000, 100000 };
+
+volatile double sink = 0.0;
+
+
+quint32 nextRandom(quint32 *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+
+// A space-padded numeral as Number fields store it, with up to
+// seven integral digits, a sign on every fourth value and the
+// given number of decimals
+QByteArray numeral(quint32 *state, int precision)
+{
+    QByteArray text;
+    if (0 == nextRandom(state) % 4) {
+        text += '-';
+    }
+    text += QByteArray::number(nextRandom(state) % 10000000);
+
+    if (0 < precision) {
+        text += '.';
+        text += QByteArray::number(nextRandom(state) % POWERS_OF_TEN[precision]).rightJustified(precision, '0');
+    }
+
+    return text.rightJustified(NUMERAL_LENGTH, ' ');
+}
+
+
+// Numerals stored back to back like the fields of a record,
+// precision cycles from zero to maxPrecision
+QByteArray numerals(int maxPrecision)
+{
+    QByteArray data;
+    data.reserve(NUMERALS_COUNT * NUMERAL_LENGTH);
+
+    quint32 state = 1;
+    for (auto i = 0; i < NUMERALS_COUNT; ++i) {
+        data += numeral(&state, i % (maxPrecision + 1));
+    }
+
+    return data;
+}
+
+
+// The conversions record() used before values were parsed in place
+double currentNumber(const QByteArray &data, int index)
+{
+    return QVariant(data.mid(index * NUMERAL_LENGTH, NUMERAL_LENGTH).trimmed()).toReal();
+}
+
+
+int currentInteger(const QByteArray &data, int index)
+{
+    return data.mid(index * NUMERAL_LENGTH, NUMERAL_LENGTH).trimmed().toInt();
+}
+
+
+double inPlaceNumber(const QByteArray &data, int index)
+{
+    bool ok;
+    return Internal::numberFromData(data.constData() + index * NUMERAL_LENGTH, NUMERAL_LENGTH, &ok);
+}
+
+
+int inPlaceInteger(const QByteArray &data, int index)
+{
+    bool ok;
+    return Internal::integerFromData(data.constData() + index * NUMERAL_LENGTH, NUMERAL_LENGTH, &ok);
+}
+
+
+template <typename T>
+bool parseBenchmark(const char *name, const QByteArray &data,
+                    T (*current)(const QByteArray &, int), T (*inPlace)(const QByteArray &, int))
+{
+    auto mismatches = 0;
+    for (auto i = 0; i < NUMERALS_COUNT; ++i) {
+        if (current(data, i) != inPlace(data, i)) {
+            ++mismatches;
+        }
+    }
+
+    const auto parse = [&data](T (*function)(const QByteArray &, int)) {
+        double sum = 0.0;
+        for (auto i = 0; i < NUMERALS_COUNT; ++i) {
+            sum += function(data, i);
+        }
+        sink = sum;
+        return true;
+    };
+
+    const auto currentNsecs = bestOf(RUNS, [&]() { return parse(current); });
+    const auto inPlaceNsecs = bestOf(RUNS, [&]() { return parse(inPlace); });
+
+    report(QString(QLatin1String("number/parse/%1/current")).arg(QLatin1String(name)),
+           double(currentNsecs) / NUMERALS_COUNT, "ns/value");
+    report(QString(QLatin1String("number/parse/%1/in place")).arg(QLatin1String(name)),
+           double(inPlaceNsecs) / NUMERALS_COUNT, "ns/value");
+    report(QString(QLatin1String("number/parse/%1/mismatches")).arg(QLatin1String(name)),
+           mismatches, "values");
+
+    return 0 == mismatches;
+}
+
+
+// A table of four integral Number fields, four Number fields with
+// two decimals and two FloatingPoint fields with four decimals
+bool recordBenchmark()
+{
+    QVector<Field> fields;
+    for (auto i = 0; i < 10; ++i) {
+        const auto &name = QByteArray("VALUE") + QByteArray::number(i);
+        const auto type = (i < 8) ? 'N' : 'F';
+        const auto precision = (i < 4) ? 0 : (i < 8) ? 2 : 4;
+        fields.append(Field{ name, type, NUMERAL_LENGTH, precision });
+    }
+
+    quint32 state = 1;
+    const auto writer = [&fields, &state](int, char *data) {
+        for (auto i = 0; i < fields.size(); ++i) {
+            memcpy(data, numeral(&state, fields.at(i).precision).constData(), NUMERAL_LENGTH);
+            data += NUMERAL_LENGTH;
+        }
+    };
+
+    const auto &fileName = dataPath(QLatin1String("numbers.dbf"));
+    if (!writeTable(fileName, 0x03, fields, RECORDS_COUNT, writer)) {
+        return false;
+    }
+
+    const auto nsecs = bestOf(RUNS, [&]() {
+        QDbfTable table;
+        if (!table.open(fileName)) {
+            return false;
+        }
+
+        double sum = 0.0;
+        while (table.next()) {
+            const auto &record = table.record();
+            for (auto i = 0; i < fields.size(); ++i) {
+                sum += record.value(i).toDouble();
+            }
+        }
+        sink = sum;
+        return true;
+    });
+
+    if (nsecs < 0) {
+        return false;
+    }
+
+    report(QLatin1String("number/record"), double(nsecs) / RECORDS_COUNT, "ns/record");
+    return true;
+}
+
+} // namespace
+
+
+bool numberBenchmark()
+{
+    auto result = parseBenchmark<int>("integer", numerals(0), currentInteger, inPlaceInteger);
+    result = parseBenchmark<double>("decimal", numerals(MAX_PRECISION), currentNumber, inPlaceNumber) && result;
+    return recordBenchmark() && result;
+}
+
+} // namespace Benchmark
@@ -0,0 +1,115 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "benchmark.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include "qdbftable.h"
+
+using namespace QDbf;
+
+
+namespace Benchmark {
+namespace {
+
+const int RUNS = 3;
+const int OPENS_COUNT = 1000;
+const int RECORDS_COUNT = 100;
+const int MEMO_BLOCK_LENGTH = 64;
+const int MEMO_HEADER_LENGTH = 512;
+const int MEMO_BLOCK_LENGTH_OFFSET = 6;
+
+const int FIELDS_COUNTS[] = { 10, 100, 250 };
+const int FIELDS_COUNTS_COUNT = int(sizeof(FIELDS_COUNTS) / sizeof(FIELDS_COUNTS[0]));
+
+const Field FIELD_TEMPLATES[] = {
+    { QByteArray(), 'C', 20, 0 },
+    { QByteArray(), 'N', 12, 2 },
+    { QByteArray(), 'D', 8, 0 },
+    { QByteArray(), 'L', 1, 0 },
+    { QByteArray(), 'I', 4, 0 }
+};
+
+
+// Writes a Visual FoxPro table with the given number of fields and an empty .fpt
+// file, the table has a memo file like most VFP tables, so open() reads both headers
+bool writeWideTable(const QString &baseName, int fieldsCount)
+{
+    QByteArray memoHeader(MEMO_HEADER_LENGTH, '\0');
+    auto data = reinterpret_cast<uchar *>(memoHeader.data());
+    qToBigEndian<quint32>(MEMO_HEADER_LENGTH / MEMO_BLOCK_LENGTH, data);
+    qToBigEndian<quint16>(MEMO_BLOCK_LENGTH, data + MEMO_BLOCK_LENGTH_OFFSET);
+    if (!writeFile(dataPath(baseName + QLatin1String(".fpt")), memoHeader)) {
+        return false;
+    }
+
+    const auto templatesCount = int(sizeof(FIELD_TEMPLATES) / sizeof(FIELD_TEMPLATES[0]));
+    QVector<Field> fields;
+    for (auto i = 0; i < fieldsCount; ++i) {
+        auto field = FIELD_TEMPLATES[i % templatesCount];
+        field.name = QByteArray("FIELD") + QByteArray::number(i);
+        fields.append(field);
+    }
+
+    return writeTable(dataPath(baseName + QLatin1String(".dbf")), 0x30, fields, RECORDS_COUNT, [](int, char *) {});
+}
+
+} // namespace
+
+
+bool openBenchmark()
+{
+    for (auto i = 0; i < FIELDS_COUNTS_COUNT; ++i) {
+        const auto fieldsCount = FIELDS_COUNTS[i];
+        const auto &baseName = QString(QLatin1String("wide%1")).arg(fieldsCount);
+        if (!writeWideTable(baseName, fieldsCount)) {
+            return false;
+        }
+
+        const auto &fileName = dataPath(baseName + QLatin1String(".dbf"));
+        const auto nsecs = bestOf(RUNS, [&fileName]() {
+            QDbfTable table;
+            for (auto i = 0; i < OPENS_COUNT; ++i) {
+                if (!table.open(fileName)) {
+                    return false;
+                }
+                table.close();
+            }
+            return true;
+        });
+
+        if (nsecs < 0) {
+            return false;
+        }
+
+        report(QString(QLatin1String("open/%1 fields")).arg(fieldsCount), double(nsecs) / 1000 / OPENS_COUNT, "us/open");
+
+        QFile::remove(fileName);
+        QFile::remove(dataPath(baseName + QLatin1String(".fpt")));
+    }
+
+    return true;
+}
+
+} // namespace Benchmark
@@ -0,0 +1,61 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+
+#ifndef QDBFAPPENDER_H
+#define QDBFAPPENDER_H
+
+#include "qdbf_compat.h"
+#include "qdbf_global.h"
+
+
+namespace QDbf {
+namespace Internal {
+class QDbfAppenderPrivate;
+} // namespace Internal
+
+class QDbfRecord;
+class QDbfTable;
+
+class QDBF_EXPORT QDbfAppender
+{
+public:
+    explicit QDbfAppender(QDbfTable &table, int checkpointInterval = 0);
+    virtual ~QDbfAppender();
+
+    void setCheckpointInterval(int checkpointInterval);
+    int checkpointInterval() const;
+
+    int pendingCount() const;
+
+    bool append(const QDbfRecord &record);
+    bool checkpoint();
+
+private:
+    Q_DISABLE_COPY(QDbfAppender)
+
+    Internal::QDbfAppenderPrivate *d;
+};
+
+} // namespace QDbf
+
+#endif // QDBFAPPENDER_H
@@ -0,0 +1,74 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef QDBFCOLUMN_H
+#define QDBFCOLUMN_H
+
+#include <QBitArray>
+#include <QString>
+#include <QVector>
+
+#include "qdbf_compat.h"
+#include "qdbf_global.h"
+#include "qdbffield.h"
+
+
+namespace QDbf {
+
+struct QDBF_EXPORT QDbfColumn
+{
+    void clear();
+
+    int fieldIndex = -1;
+    QDbfField::QDbfType type = QDbfField::Undefined;
+
+    // Integer and Logical
+    QVector<qint32> int32Values;
+    // Number, FloatingPoint and Currency
+    QVector<double> doubleValues;
+    // Date and DateTime
+    QVector<qint32> julianDays;
+    // DateTime
+    QVector<qint32> milliseconds;
+    // Character and Memo, value i is stringData.mid(stringOffsets[i], stringOffsets[i + 1] - stringOffsets[i])
+    QVector<int> stringOffsets;
+    QString stringData;
+    // Interned Character, value i is dictionary[codes[i]]
+    QVector<qint32> codes;
+    QVector<QString> dictionary;
+
+    QBitArray nulls;
+};
+
+struct QDBF_EXPORT QDbfColumnBatch
+{
+    void clear();
+
+    int first = 0;
+    int count = 0;
+    QBitArray deleted;
+    QVector<QDbfColumn> columns;
+};
+
+} // namespace QDbf
+
+#endif // QDBFCOLUMN_H
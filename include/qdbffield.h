@@ -31,9 +31,12 @@
 namespace QDbf {
 namespace Internal {
 class QDbfFieldPrivate;
+class QDbfRecordPrivate;
 class QDbfTablePrivate;
 } // namespace Internal
 
+class QDbfRecord;
+
 class QDBF_EXPORT QDbfField
 {
 public:
@@ -98,7 +101,9 @@ private:
     QVariant val;
     void detach();
 
+    friend class Internal::QDbfRecordPrivate;
     friend class Internal::QDbfTablePrivate;
+    friend class QDbfRecord;
 };
 
 void swap(QDbfField &lhs, QDbfField &rhs);
@@ -0,0 +1,85 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef QDBFFILTER_H
+#define QDBFFILTER_H
+
+#include <QVariant>
+
+#include "qdbf_compat.h"
+#include "qdbf_global.h"
+
+
+namespace QDbf {
+namespace Internal {
+class QDbfFilterPrivate;
+} // namespace Internal
+
+class QDBF_EXPORT QDbfFilter
+{
+public:
+    enum Operator {
+        Equals = 0,
+        Range,
+        Prefix,
+        In
+    };
+
+    struct Condition {
+        QDbfFilter::Operator op;
+        int fieldIndex;
+        QVariantList values;
+    };
+
+    QDbfFilter();
+
+    QDbfFilter(const QDbfFilter &other);
+    QDbfFilter(QDbfFilter &&other) Q_DECL_NOEXCEPT;
+
+    QDbfFilter &operator=(const QDbfFilter &other);
+    QDbfFilter &operator=(QDbfFilter &&other) Q_DECL_NOEXCEPT;
+
+    virtual ~QDbfFilter();
+
+    QDbfFilter &addEquals(int fieldIndex, const QVariant &value);
+    QDbfFilter &addRange(int fieldIndex, const QVariant &minimum, const QVariant &maximum);
+    QDbfFilter &addPrefix(int fieldIndex, const QString &prefix);
+    QDbfFilter &addIn(int fieldIndex, const QVariantList &values);
+
+    int count() const;
+    Condition condition(int index) const;
+
+    bool isEmpty() const;
+    void clear();
+
+    void swap(QDbfFilter &other) Q_DECL_NOEXCEPT;
+
+private:
+    Internal::QDbfFilterPrivate *d;
+    void detach();
+};
+
+void swap(QDbfFilter &lhs, QDbfFilter &rhs);
+
+} // namespace QDbf
+
+#endif // QDBFFILTER_H
@@ -34,10 +34,25 @@ QT_END_NAMESPACE
 namespace QDbf {
 namespace Internal {
 class QDbfRecordPrivate;
+class QDbfTablePrivate;
 }
 
 class QDbfField;
 
+// A field index resolved once by name, for name-based access in hot loops
+class QDBF_EXPORT QDbfFieldKey
+{
+public:
+    QDbfFieldKey() = default;
+    explicit QDbfFieldKey(int fieldIndex) : m_index(fieldIndex) {}
+
+    int index() const { return m_index; }
+    bool isValid() const { return m_index >= 0; }
+
+private:
+    int m_index = -1;
+};
+
 class QDBF_EXPORT QDbfRecord
 {
 public:
@@ -63,6 +78,9 @@ public:
     void setValue(const QString &fieldName, QVariant value);
     QVariant value(const QString &fieldName) const;
 
+    void setValue(QDbfFieldKey key, QVariant value);
+    QVariant value(QDbfFieldKey key) const;
+
     void setNull(int fieldIndex);
     bool isNull(int fieldIndex) const;
 
@@ -70,6 +88,7 @@ public:
     bool isNull(const QString &fieldName) const;
 
     int indexOf(const QString &fieldName) const;
+    QDbfFieldKey fieldKey(const QString &fieldName) const;
     QString fieldName(int fieldIndex) const;
 
     QDbfField field(int fieldIndex) const;
@@ -96,6 +115,9 @@ public:
 private:
     Internal::QDbfRecordPrivate *d;
     void detach();
+    bool sharesSchema(const QDbfRecord &other) const;
+
+    friend class Internal::QDbfTablePrivate;
 };
 
 void swap(QDbfRecord &lhs, QDbfRecord &rhs);
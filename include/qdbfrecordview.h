@@ -0,0 +1,76 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef QDBFRECORDVIEW_H
+#define QDBFRECORDVIEW_H
+
+#include "qdbf_compat.h"
+#include "qdbf_global.h"
+#include "qdbffield.h"
+
+QT_BEGIN_NAMESPACE
+class QByteArray;
+class QDate;
+QT_END_NAMESPACE
+
+
+namespace QDbf {
+namespace Internal {
+struct QDbfFieldLayout;
+class QDbfTablePrivate;
+} // namespace Internal
+
+class QDBF_EXPORT QDbfRecordView
+{
+public:
+    QDbfRecordView();
+
+    bool isValid() const;
+    int recordIndex() const;
+    bool isDeleted() const;
+    int count() const;
+
+    QDbfField::QDbfType type(int fieldIndex) const;
+
+    qint32 int32At(int fieldIndex) const;
+    double doubleAt(int fieldIndex) const;
+    bool boolAt(int fieldIndex) const;
+    QDate dateAt(int fieldIndex) const;
+    QByteArray rawAt(int fieldIndex) const;
+
+private:
+    QDbfRecordView(const char *data, const Internal::QDbfFieldLayout *fields, int count, int index);
+
+    const char *m_data = nullptr;
+    const Internal::QDbfFieldLayout *m_fields = nullptr;
+    int m_count = 0;
+    int m_index = -1;
+
+    friend class QDbfTable;
+    friend class Internal::QDbfTablePrivate;
+};
+
+} // namespace QDbf
+
+Q_DECLARE_TYPEINFO(QDbf::QDbfRecordView, Q_MOVABLE_TYPE);
+
+#endif // QDBFRECORDVIEW_H
@@ -22,23 +22,33 @@
 #ifndef QDBFTABLE_H
 #define QDBFTABLE_H
 
+#include <functional>
+
 #include <QString>
+#include <QtContainerFwd>
 
 #include "qdbf_compat.h"
 #include "qdbf_global.h"
 
 QT_BEGIN_NAMESPACE
+class QBitArray;
 class QDate;
+class QStringList;
 class QVariant;
 QT_END_NAMESPACE
 
 
 namespace QDbf {
 namespace Internal {
+class QDbfTableAppendAccess;
 class QDbfTablePrivate;
 } // namespace Internal
 
+struct QDbfColumnBatch;
+class QDbfFieldKey;
+class QDbfFilter;
 class QDbfRecord;
+class QDbfRecordView;
 
 class QDBF_EXPORT QDbfTable
 {
@@ -57,7 +67,20 @@ public:
 
     enum OpenMode {
         ReadOnly = 0,
-        ReadWrite
+        ReadWrite,
+        MappedReadOnly
+    };
+
+    enum MemoLoading {
+        ImmediateMemoLoading = 0,
+        DeferredMemoLoading
+    };
+
+    enum Durability {
+        NoSync = 0,
+        SyncOnClose,
+        SyncOnCommit,
+        PeriodicSync
     };
 
     enum DbfTableError {
@@ -71,6 +94,17 @@ public:
         UnsupportedFile
     };
 
+    typedef std::function<QVariant (int first, const QVector<QDbfRecordView> &records)> ScanFunction;
+    typedef std::function<QVariant (const QVariant &result, const QVariant &chunkResult)> ReduceFunction;
+
+    struct Statistics {
+        qint64 memoCacheHits = 0;
+        qint64 memoCacheMisses = 0;
+        qint64 syncCount = 0;
+        qint64 syncNsecs = 0;
+        qint64 maxSyncNsecs = 0;
+    };
+
     explicit QDbfTable(QString dbfFileName = QString());
 
     QDbfTable(QDbfTable &&other) Q_DECL_NOEXCEPT;
@@ -91,6 +125,10 @@ public:
     void setDefaultCodepage(QDbfTable::Codepage codepage);
 
     bool isOpen() const;
+    bool isMapped() const;
+
+    void setReadAheadSize(int size);
+    int readAheadSize() const;
 
     int size() const;
     int at() const;
@@ -102,8 +140,56 @@ public:
 
     QDate lastUpdate() const;
 
+    bool setProjection(const QStringList &fieldNames);
+    bool setProjection(const QVector<int> &fieldIndexes);
+    void clearProjection();
+
+    bool setFilter(const QDbfFilter &filter);
+    QDbfFilter filter() const;
+    void clearFilter();
+    bool nextMatching() const;
+
+    QBitArray liveRecords() const;
+    int liveRecordsCount() const;
+    bool nextLive() const;
+
+    bool setInterned(int fieldIndex, bool interned = true);
+    bool isInterned(int fieldIndex) const;
+    QVector<QString> dictionary(int fieldIndex) const;
+    int dictionaryCode(int fieldIndex) const;
+
+    void setMemoLoading(QDbfTable::MemoLoading memoLoading);
+    QDbfTable::MemoLoading memoLoading() const;
+
+    void setMemoCacheSize(int size);
+    int memoCacheSize() const;
+
+    void setDurability(QDbfTable::Durability durability);
+    QDbfTable::Durability durability() const;
+
+    void setSyncRecordsInterval(int records);
+    int syncRecordsInterval() const;
+
+    void setSyncTimeInterval(int msecs);
+    int syncTimeInterval() const;
+
+    bool sync();
+
+    QDbfTable::Statistics statistics() const;
+    void resetStatistics();
+
     bool setRecord(const QDbfRecord &record);
     QDbfRecord record() const;
+    bool readRecord(QDbfRecord &record) const;
+    bool readRecords(int first, int count, QVector<QDbfRecord> &records) const;
+    QDbfRecordView recordView() const;
+
+    bool readColumns(int first, int count, const QVector<int> &fieldIndexes, QDbfColumnBatch &batch) const;
+
+    // Chunk results are combined with reduce in chunk order, without
+    // a reduce function they come back as a QVariantList in that order
+    QVariant parallelScan(const ScanFunction &function, const ReduceFunction &reduce = ReduceFunction(),
+                          int chunkSize = 0) const;
 
     bool setValue(int fieldIndex, const QVariant &value);
     QVariant value(int fieldIndex) const;
@@ -111,22 +197,54 @@ public:
     bool setValue(const QString &name, const QVariant &value);
     QVariant value(const QString &name) const;
 
+    QDbfFieldKey fieldKey(const QString &name) const;
+    bool setValue(QDbfFieldKey key, const QVariant &value);
+    QVariant value(QDbfFieldKey key) const;
+
+    QVariant memo(int fieldIndex) const;
+
+    bool isNull(int fieldIndex) const;
+    bool isNull(const QString &name) const;
+
     bool addRecord();
     bool addRecord(const QDbfRecord &record);
+    bool addRecords(const QVector<QDbfRecord> &records);
 
     bool removeRecord(int index);
     bool removeRecord();
 
+    bool beginBatch();
+    bool commit();
+    bool isBatchActive() const;
+
     void swap(QDbfTable &other) Q_DECL_NOEXCEPT;
 
 private:
     Q_DISABLE_COPY(QDbfTable)
 
     Internal::QDbfTablePrivate *d;
+
+    friend class Internal::QDbfTableAppendAccess;
 };
 
 void swap(QDbfTable &lhs, QDbfTable &rhs);
 
+
+class QDBF_EXPORT QDbfWriteBatch
+{
+public:
+    explicit QDbfWriteBatch(QDbfTable &table);
+    ~QDbfWriteBatch();
+
+    bool commit();
+
+private:
+    Q_DISABLE_COPY(QDbfWriteBatch)
+
+    QDbfTable &m_table;
+    bool m_active;
+};
+
 } // namespace QDbf
 
 QDebug operator<<(QDebug, const QDbf::QDbfTable &);
@@ -54,6 +54,8 @@ public:
     QDbfTable::DbfTableError error() const;
     QDate lastUpdate() const;
 
+    bool setInterned(int column, bool interned = true);
+
     int rowCount(const QModelIndex &index = QModelIndex()) const override;
     int columnCount(const QModelIndex &index = QModelIndex()) const override;
 
@@ -25,3 +25,9 @@ TEMPLATE = subdirs
 CONFIG += ordered
 SUBDIRS = src \
           example
+
+# Run qmake with CONFIG+=benchmarks to build the benchmarks as well
+benchmarks:SUBDIRS += benchmark
+
+# Run qmake with CONFIG+=tests to build the tests, make check runs them
+tests:SUBDIRS += tests
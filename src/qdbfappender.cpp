@@ -0,0 +1,119 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+
+#include <QByteArray>
+
+#include "qdbfappender.h"
+#include "qdbftable_p.h"
+
+
+namespace QDbf {
+namespace Internal {
+
+class QDbfAppenderPrivate final
+{
+public:
+    QDbfAppenderPrivate(QDbfTable &table, int checkpointInterval);
+
+    QDbfTable &m_table;
+    QByteArray m_buffer;
+    int m_checkpointInterval;
+    int m_pendingCount = 0;
+};
+
+
+QDbfAppenderPrivate::QDbfAppenderPrivate(QDbfTable &table, int checkpointInterval) :
+    m_table(table),
+    m_checkpointInterval(qMax(checkpointInterval, 0))
+{
+}
+
+} // namespace Internal
+
+
+QDbfAppender::QDbfAppender(QDbfTable &table, int checkpointInterval) :
+    d(new Internal::QDbfAppenderPrivate(table, checkpointInterval))
+{
+}
+
+
+QDbfAppender::~QDbfAppender()
+{
+    checkpoint();
+    delete d;
+    d = nullptr;
+}
+
+
+// The header is updated every checkpointInterval records, zero leaves it to checkpoint()
+void QDbfAppender::setCheckpointInterval(int checkpointInterval)
+{
+    d->m_checkpointInterval = qMax(checkpointInterval, 0);
+}
+
+
+int QDbfAppender::checkpointInterval() const
+{
+    return d->m_checkpointInterval;
+}
+
+
+int QDbfAppender::pendingCount() const
+{
+    return d->m_pendingCount;
+}
+
+
+// Records are encoded into a buffer and go to the file sequentially as it fills up
+bool QDbfAppender::append(const QDbfRecord &record)
+{
+    if (!Internal::QDbfTableAppendAccess::appendRecord(d->m_table, record, d->m_buffer)) {
+        return false;
+    }
+
+    ++d->m_pendingCount;
+
+    if (d->m_checkpointInterval > 0 && d->m_pendingCount >= d->m_checkpointInterval) {
+        return checkpoint();
+    }
+
+    return true;
+}
+
+
+// Writes the buffered records, then the records count, last update date and memo header
+bool QDbfAppender::checkpoint()
+{
+    if (0 == d->m_pendingCount) {
+        return true;
+    }
+
+    if (!Internal::QDbfTableAppendAccess::flushRecords(d->m_table, d->m_buffer)) {
+        return false;
+    }
+
+    d->m_pendingCount = 0;
+    return true;
+}
+
+} // namespace QDbf
@@ -0,0 +1,62 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+
+#ifndef QDBFCODEC_P_H
+#define QDBFCODEC_P_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include "qdbftable.h"
+
+QT_BEGIN_NAMESPACE
+class QTextCodec;
+QT_END_NAMESPACE
+
+
+namespace QDbf {
+namespace Internal {
+
+// Decodes the single-byte codepages through built-in tables and the rest through QTextCodec
+class QDbfCodec final
+{
+public:
+    QDbfCodec();
+
+    void setCodepage(QDbfTable::Codepage codepage);
+
+    QString toUnicode(const char *data, int length) const;
+    QString toUnicode(const QByteArray &byteArray) const;
+    QByteArray fromUnicode(const QString &string) const;
+
+private:
+    const ushort *m_table = nullptr;
+    QTextCodec *m_textCodec;
+    QHash<ushort, char> m_encoding;
+};
+
+} // namespace Internal
+} // namespace QDbf
+
+#endif // QDBFCODEC_P_H
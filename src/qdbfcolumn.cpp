@@ -0,0 +1,54 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "qdbfcolumn.h"
+
+
+namespace QDbf {
+
+void QDbfColumn::clear()
+{
+    fieldIndex = -1;
+    type = QDbfField::Undefined;
+    int32Values.resize(0);
+    doubleValues.resize(0);
+    julianDays.resize(0);
+    milliseconds.resize(0);
+    stringOffsets.resize(0);
+    stringData.resize(0);
+    codes.resize(0);
+    dictionary.clear();
+    nulls.resize(0);
+}
+
+
+void QDbfColumnBatch::clear()
+{
+    first = 0;
+    count = 0;
+    deleted.resize(0);
+    for (auto i = 0; i < columns.size(); ++i) {
+        columns[i].clear();
+    }
+}
+
+} // namespace QDbf
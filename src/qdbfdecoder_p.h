@@ -0,0 +1,291 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef QDBFDECODER_P_H
+#define QDBFDECODER_P_H
+
+#include <limits>
+
+#include <QByteArray>
+#include <QDate>
+#include <QVector>
+#include <QtEndian>
+
+#include "qdbffield.h"
+
+
+namespace QDbf {
+namespace Internal {
+
+enum QDbfDecoder {
+    InvalidDecoder = 0,
+    CharacterDecoder,
+    CurrencyDecoder,
+    DateDecoder,
+    IntegralNumberDecoder,
+    DecimalNumberDecoder,
+    LogicalDecoder,
+    MemoDecoder,
+    IntegerDecoder,
+    DateTimeDecoder,
+    TimestampDecoder
+};
+
+struct QDbfFieldLayout
+{
+    QDbfField::QDbfType type;
+    QDbfDecoder decoder;
+    int offset;
+    int length;
+    int precision;
+    double scale; // 10^precision, the divisor of Currency values
+    bool interned;
+};
+
+typedef QVector<QDbfFieldLayout> QDbfRecordLayout;
+
+
+inline qint32 int32FromData(const char *data)
+{
+    return qFromLittleEndian<qint32>(reinterpret_cast<const uchar *>(data));
+}
+
+
+inline qint64 int64FromData(const char *data)
+{
+    return qFromLittleEndian<qint64>(reinterpret_cast<const uchar *>(data));
+}
+
+
+inline int digitsFromData(const char *data, int length, bool *ok)
+{
+    auto value = 0;
+    for (auto i = 0; i < length; ++i) {
+        const auto digit = data[i] - '0';
+        if (digit < 0 || 9 < digit) {
+            *ok = false;
+            return 0;
+        }
+        value = value * 10 + digit;
+    }
+
+    *ok = true;
+    return value;
+}
+
+
+inline bool isBlank(const char *data, int length)
+{
+    for (auto i = 0; i < length; ++i) {
+        if (' ' != data[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Powers of ten which are exactly representable as a double
+const double EXACT_POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Up to 15 significant digits the mantissa converts to a double without rounding
+const int MAX_EXACT_DIGITS = 15;
+const int MAX_EXACT_FRACTION_DIGITS = 22;
+
+
+inline bool isPadding(char c)
+{
+    return ' ' == c || ('\t' <= c && c <= '\r');
+}
+
+
+inline void trimData(const char *data, int *begin, int *end)
+{
+    while (*begin < *end && isPadding(data[*begin])) {
+        ++*begin;
+    }
+
+    while (*end > *begin && isPadding(data[*end - 1])) {
+        --*end;
+    }
+}
+
+
+inline void setOk(bool *ok, bool value)
+{
+    if (nullptr != ok) {
+        *ok = value;
+    }
+}
+
+
+// Parses the space-padded integral numerals used by Number fields without decimals
+inline int integerFromData(const char *data, int length, bool *ok)
+{
+    auto begin = 0;
+    auto end = length;
+    trimData(data, &begin, &end);
+
+    auto negative = false;
+    if (begin < end && ('-' == data[begin] || '+' == data[begin])) {
+        negative = ('-' == data[begin]);
+        ++begin;
+    }
+
+    if (begin == end) {
+        setOk(ok, false);
+        return 0;
+    }
+
+    const qint64 limit = negative ? qint64(std::numeric_limits<int>::max()) + 1 : std::numeric_limits<int>::max();
+    qint64 value = 0;
+    for (auto i = begin; i < end; ++i) {
+        const auto digit = data[i] - '0';
+        if (digit < 0 || 9 < digit) {
+            setOk(ok, false);
+            return 0;
+        }
+
+        value = value * 10 + digit;
+        if (value > limit) {
+            setOk(ok, false);
+            return 0;
+        }
+    }
+
+    setOk(ok, true);
+    return int(negative ? -value : value);
+}
+
+
+// Parses the space-padded text representation used by Number and FloatingPoint fields.
+// Plain decimal numerals are converted in place as mantissa / 10^n, which is exact
+// for the precisions DBF files use, anything else falls back to QByteArray::toDouble()
+inline double numberFromData(const char *data, int length, bool *ok)
+{
+    auto begin = 0;
+    auto end = length;
+    trimData(data, &begin, &end);
+    const auto start = begin;
+
+    auto negative = false;
+    if (begin < end && ('-' == data[begin] || '+' == data[begin])) {
+        negative = ('-' == data[begin]);
+        ++begin;
+    }
+
+    quint64 mantissa = 0;
+    auto digits = 0;
+    auto fractionDigits = 0;
+    auto point = false;
+    auto empty = true;
+    for (auto i = begin; i < end; ++i) {
+        const auto c = data[i];
+        if ('.' == c && !point) {
+            point = true;
+            continue;
+        }
+
+        const auto digit = c - '0';
+        if (digit < 0 || 9 < digit || MAX_EXACT_DIGITS == digits) {
+            return QByteArray(data + start, end - start).toDouble(ok);
+        }
+
+        empty = false;
+        if (point) {
+            ++fractionDigits;
+        }
+
+        if (0 != mantissa || 0 != digit) {
+            mantissa = mantissa * 10 + quint64(digit);
+            ++digits;
+        }
+    }
+
+    if (empty) {
+        setOk(ok, false);
+        return 0.0;
+    }
+
+    if (fractionDigits > MAX_EXACT_FRACTION_DIGITS) {
+        return QByteArray(data + start, end - start).toDouble(ok);
+    }
+
+    setOk(ok, true);
+    const auto value = double(mantissa) / EXACT_POWERS_OF_TEN[fractionDigits];
+    return negative ? -value : value;
+}
+
+
+// Parses the yyyyMMdd representation used by Date fields
+inline QDate dateFromData(const char *data)
+{
+    auto ok = false;
+
+    const auto y = digitsFromData(data, 4, &ok);
+    if (!ok) {
+        return {};
+    }
+
+    const auto m = digitsFromData(data + 4, 2, &ok);
+    if (!ok) {
+        return {};
+    }
+
+    const auto d = digitsFromData(data + 6, 2, &ok);
+    if (!ok) {
+        return {};
+    }
+
+    return { y, m, d };
+}
+
+
+// Parses the HHmmss representation used by DateTime fields
+inline int millisecondsFromData(const char *data, bool *ok)
+{
+    const auto h = digitsFromData(data, 2, ok);
+    if (!*ok) {
+        return 0;
+    }
+
+    const auto m = digitsFromData(data + 2, 2, ok);
+    if (!*ok) {
+        return 0;
+    }
+
+    const auto s = digitsFromData(data + 4, 2, ok);
+    if (!*ok) {
+        return 0;
+    }
+
+    return ((h * 60 + m) * 60 + s) * 1000;
+}
+
+} // namespace Internal
+} // namespace QDbf
+
+#endif // QDBFDECODER_P_H
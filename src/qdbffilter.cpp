@@ -0,0 +1,175 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include <QVector>
+
+#include "qdbffilter.h"
+
+
+namespace QDbf {
+namespace Internal {
+
+class QDbfFilterPrivate final
+{
+public:
+    QDbfFilterPrivate() = default;
+    QDbfFilterPrivate(const QDbfFilterPrivate &other);
+    QDbfFilterPrivate(QDbfFilterPrivate &&other) = delete;
+    QDbfFilterPrivate &operator=(const QDbfFilterPrivate &other) = delete;
+    QDbfFilterPrivate &operator=(QDbfFilterPrivate &&other) = delete;
+    virtual ~QDbfFilterPrivate() = default;
+
+    QAtomicInt ref = 1;
+    QVector<QDbfFilter::Condition> m_conditions;
+};
+
+
+QDbfFilterPrivate::QDbfFilterPrivate(const QDbfFilterPrivate &other) :
+    m_conditions(other.m_conditions)
+{
+}
+
+} // namespace Internal
+
+
+QDbfFilter::QDbfFilter() :
+    d(new Internal::QDbfFilterPrivate())
+{
+}
+
+
+QDbfFilter::QDbfFilter(const QDbfFilter &other) :
+    d(other.d)
+{
+    d->ref.ref();
+}
+
+
+QDbfFilter::QDbfFilter(QDbfFilter &&other) Q_DECL_NOEXCEPT :
+    d(other.d)
+{
+    other.d = nullptr;
+}
+
+
+QDbfFilter &QDbfFilter::operator=(const QDbfFilter &other)
+{
+    if (this == &other) {
+        return *this;
+    }
+
+    qAtomicAssign(d, other.d);
+    return *this;
+}
+
+
+QDbfFilter &QDbfFilter::operator=(QDbfFilter &&other) Q_DECL_NOEXCEPT
+{
+    other.swap(*this);
+    return *this;
+}
+
+
+QDbfFilter::~QDbfFilter()
+{
+    if (nullptr != d && !d->ref.deref()) {
+        delete d;
+        d = nullptr;
+    }
+}
+
+
+QDbfFilter &QDbfFilter::addEquals(int fieldIndex, const QVariant &value)
+{
+    detach();
+    d->m_conditions.append({ QDbfFilter::Equals, fieldIndex, QVariantList() << value });
+    return *this;
+}
+
+
+QDbfFilter &QDbfFilter::addRange(int fieldIndex, const QVariant &minimum, const QVariant &maximum)
+{
+    detach();
+    d->m_conditions.append({ QDbfFilter::Range, fieldIndex, QVariantList() << minimum << maximum });
+    return *this;
+}
+
+
+QDbfFilter &QDbfFilter::addPrefix(int fieldIndex, const QString &prefix)
+{
+    detach();
+    d->m_conditions.append({ QDbfFilter::Prefix, fieldIndex, QVariantList() << prefix });
+    return *this;
+}
+
+
+QDbfFilter &QDbfFilter::addIn(int fieldIndex, const QVariantList &values)
+{
+    detach();
+    d->m_conditions.append({ QDbfFilter::In, fieldIndex, values });
+    return *this;
+}
+
+
+int QDbfFilter::count() const
+{
+    return d->m_conditions.count();
+}
+
+
+QDbfFilter::Condition QDbfFilter::condition(int index) const
+{
+    return d->m_conditions.at(index);
+}
+
+
+bool QDbfFilter::isEmpty() const
+{
+    return d->m_conditions.isEmpty();
+}
+
+
+void QDbfFilter::clear()
+{
+    detach();
+    d->m_conditions.clear();
+}
+
+
+void QDbfFilter::swap(QDbfFilter &other) Q_DECL_NOEXCEPT
+{
+    std::swap(d, other.d);
+}
+
+
+void QDbfFilter::detach()
+{
+    qAtomicDetach(d);
+}
+
+
+void swap(QDbfFilter &lhs, QDbfFilter &rhs)
+{
+    lhs.swap(rhs);
+}
+
+} // namespace QDbf
@@ -20,6 +20,7 @@
 ***************************************************************************/
 
 #include <QDebug>
+#include <QHash>
 #include <QVariant>
 #include <QVector>
 
@@ -30,28 +31,99 @@
 namespace QDbf {
 namespace Internal {
 
+// Field descriptions without values, shared by every record with the same layout
+class QDbfRecordSchema final
+{
+public:
+    QDbfRecordSchema() = default;
+    QDbfRecordSchema(const QDbfRecordSchema &other);
+    QDbfRecordSchema(QDbfRecordSchema &&other) = delete;
+    QDbfRecordSchema &operator=(const QDbfRecordSchema &other) = delete;
+    QDbfRecordSchema &operator=(QDbfRecordSchema &&other) = delete;
+    virtual ~QDbfRecordSchema() = default;
+
+    void updateNameIndex();
+
+    QAtomicInt ref = 1;
+    QVector<QDbfField> m_fields;
+    // Upper-cased field name to the first field with that name
+    QHash<QString, int> m_nameIndex;
+};
+
+
 class QDbfRecordPrivate final
 {
 public:
-    QDbfRecordPrivate() = default;
+    QDbfRecordPrivate();
     QDbfRecordPrivate(const QDbfRecordPrivate &other);
     QDbfRecordPrivate(QDbfRecordPrivate &&other) = delete;
     QDbfRecordPrivate &operator=(const QDbfRecordPrivate &other) = delete;
     QDbfRecordPrivate &operator=(QDbfRecordPrivate &&other) = delete;
-    virtual ~QDbfRecordPrivate() = default;
+    virtual ~QDbfRecordPrivate();
+
+    void detachSchema();
+    static QDbfField schemaField(const QDbfField &field);
 
     QAtomicInt ref = 1;
     int m_index = -1;
-    QVector<QDbfField> m_fields;
+    QDbfRecordSchema *m_schema;
+    QVector<QVariant> m_values;
     bool m_deleted = false;
 };
 
 
+QDbfRecordSchema::QDbfRecordSchema(const QDbfRecordSchema &other) :
+    m_fields(other.m_fields),
+    m_nameIndex(other.m_nameIndex)
+{
+}
+
+
+void QDbfRecordSchema::updateNameIndex()
+{
+    m_nameIndex.clear();
+    for (auto i = m_fields.count() - 1; i >= 0; --i) {
+        m_nameIndex.insert(m_fields.at(i).name().toUpper(), i);
+    }
+}
+
+
+QDbfRecordPrivate::QDbfRecordPrivate() :
+    m_schema(new QDbfRecordSchema())
+{
+}
+
+
 QDbfRecordPrivate::QDbfRecordPrivate(const QDbfRecordPrivate &other) :
     m_index(other.m_index),
-    m_fields(other.m_fields),
+    m_schema(other.m_schema),
+    m_values(other.m_values),
     m_deleted(other.m_deleted)
 {
+    m_schema->ref.ref();
+}
+
+
+QDbfRecordPrivate::~QDbfRecordPrivate()
+{
+    if (!m_schema->ref.deref()) {
+        delete m_schema;
+    }
+    m_schema = nullptr;
+}
+
+
+void QDbfRecordPrivate::detachSchema()
+{
+    qAtomicDetach(m_schema);
+}
+
+
+QDbfField QDbfRecordPrivate::schemaField(const QDbfField &field)
+{
+    QDbfField result(field);
+    result.val = QVariant();
+    return result;
 }
 
 } // namespace Internal
@@ -99,7 +171,8 @@ bool QDbfRecord::operator==(const QDbfRecord &other) const
 {
     return (recordIndex() == other.recordIndex() &&
             isDeleted() == other.isDeleted() &&
-            d->m_fields == other.d->m_fields);
+            (d->m_schema == other.d->m_schema || d->m_schema->m_fields == other.d->m_schema->m_fields) &&
+            d->m_values == other.d->m_values);
 }
 
 
@@ -136,14 +209,18 @@ void QDbfRecord::setValue(int fieldIndex, QVariant value)
         return;
     }
 
+    if (d->m_schema->m_fields.at(fieldIndex).isReadOnly()) {
+        return;
+    }
+
     detach();
-    d->m_fields[fieldIndex].setValue(std::move(value));
+    d->m_values[fieldIndex] = std::move(value);
 }
 
 
 QVariant QDbfRecord::value(int fieldIndex) const
 {
-    return d->m_fields.value(fieldIndex).value();
+    return d->m_values.value(fieldIndex);
 }
 
 
@@ -159,20 +236,37 @@ QVariant QDbfRecord::value(const QString &fieldName) const
 }
 
 
+void QDbfRecord::setValue(QDbfFieldKey key, QVariant value)
+{
+    setValue(key.index(), std::move(value));
+}
+
+
+QVariant QDbfRecord::value(QDbfFieldKey key) const
+{
+    return value(key.index());
+}
+
+
 void QDbfRecord::setNull(int fieldIndex)
 {
     if (!contains(fieldIndex)) {
         return;
     }
 
+    const auto &field = d->m_schema->m_fields.at(fieldIndex);
+    if (field.isReadOnly()) {
+        return;
+    }
+
     detach();
-    d->m_fields[fieldIndex].clear();
+    d->m_values[fieldIndex] = field.defaultValue();
 }
 
 
 bool QDbfRecord::isNull(int fieldIndex) const
 {
-    return d->m_fields.value(fieldIndex).isNull();
+    return d->m_values.value(fieldIndex).isNull();
 }
 
 
@@ -190,27 +284,43 @@ bool QDbfRecord::isNull(const QString &fieldName) const
 
 int QDbfRecord::indexOf(const QString &fieldName) const
 {
-    const auto &name = fieldName.toUpper();
+    // DBF field names are upper case, so the exact lookup hits without allocating
+    const auto &nameIndex = d->m_schema->m_nameIndex;
+    auto it = nameIndex.constFind(fieldName);
+    if (it != nameIndex.constEnd()) {
+        return it.value();
+    }
 
-    for (auto i = 0; i < count(); ++i) {
-        if (d->m_fields.at(i).name().toUpper() == name) {
-            return i;
-        }
+    it = nameIndex.constFind(fieldName.toUpper());
+    if (it != nameIndex.constEnd()) {
+        return it.value();
     }
 
     return -1;
 }
 
 
+QDbfFieldKey QDbfRecord::fieldKey(const QString &fieldName) const
+{
+    return QDbfFieldKey(indexOf(fieldName));
+}
+
+
 QString QDbfRecord::fieldName(int fieldIndex) const
 {
-    return d->m_fields.value(fieldIndex).name();
+    return d->m_schema->m_fields.value(fieldIndex).name();
 }
 
 
 QDbfField QDbfRecord::field(int fieldIndex) const
 {
-    return d->m_fields.value(fieldIndex);
+    if (!contains(fieldIndex)) {
+        return QDbfField();
+    }
+
+    auto field = d->m_schema->m_fields.at(fieldIndex);
+    field.val = d->m_values.at(fieldIndex);
+    return field;
 }
 
 
@@ -223,7 +333,14 @@ QDbfField QDbfRecord::field(const QString &fieldName) const
 void QDbfRecord::append(const QDbfField &field)
 {
     detach();
-    d->m_fields.append(field);
+    d->detachSchema();
+    d->m_schema->m_fields.append(Internal::QDbfRecordPrivate::schemaField(field));
+    d->m_values.append(field.value());
+
+    const auto &name = field.name().toUpper();
+    if (!d->m_schema->m_nameIndex.contains(name)) {
+        d->m_schema->m_nameIndex.insert(name, d->m_schema->m_fields.count() - 1);
+    }
 }
 
 
@@ -234,14 +351,20 @@ void QDbfRecord::replace(int pos, const QDbfField &field)
     }
 
     detach();
-    d->m_fields[pos] = field;
+    d->detachSchema();
+    d->m_schema->m_fields[pos] = Internal::QDbfRecordPrivate::schemaField(field);
+    d->m_schema->updateNameIndex();
+    d->m_values[pos] = field.value();
 }
 
 
 void QDbfRecord::insert(int pos, const QDbfField &field)
 {
     detach();
-    d->m_fields.insert(pos, field);
+    d->detachSchema();
+    d->m_schema->m_fields.insert(pos, Internal::QDbfRecordPrivate::schemaField(field));
+    d->m_schema->updateNameIndex();
+    d->m_values.insert(pos, field.value());
 }
 
 
@@ -252,13 +375,16 @@ void QDbfRecord::remove(int pos)
     }
 
     detach();
-    d->m_fields.remove(pos);
+    d->detachSchema();
+    d->m_schema->m_fields.remove(pos);
+    d->m_schema->updateNameIndex();
+    d->m_values.remove(pos);
 }
 
 
 bool QDbfRecord::isEmpty() const
 {
-    return d->m_fields.isEmpty();
+    return d->m_schema->m_fields.isEmpty();
 }
 
 
@@ -277,7 +403,7 @@ bool QDbfRecord::isDeleted() const
 
 bool QDbfRecord::contains(int fieldIndex) const
 {
-    return fieldIndex >= 0 && fieldIndex < d->m_fields.count();
+    return fieldIndex >= 0 && fieldIndex < d->m_values.count();
 }
 
 
@@ -290,23 +416,28 @@ bool QDbfRecord::contains(const QString &fieldName) const
 void QDbfRecord::clear()
 {
     detach();
-    d->m_fields.clear();
+    d->detachSchema();
+    d->m_schema->m_fields.clear();
+    d->m_schema->m_nameIndex.clear();
+    d->m_values.clear();
 }
 
 
 void QDbfRecord::clearValues()
 {
     detach();
-    int count = d->m_fields.count();
-    for (auto i = 0; i < count; ++i) {
-        d->m_fields[i].clear();
+    const auto &fields = d->m_schema->m_fields;
+    for (auto i = 0; i < fields.count(); ++i) {
+        if (!fields.at(i).isReadOnly()) {
+            d->m_values[i] = fields.at(i).defaultValue();
+        }
     }
 }
 
 
 int QDbfRecord::count() const
 {
-    return d->m_fields.count();
+    return d->m_values.count();
 }
 
 
@@ -322,6 +453,12 @@ void QDbfRecord::detach()
 }
 
 
+bool QDbfRecord::sharesSchema(const QDbfRecord &other) const
+{
+    return d->m_schema == other.d->m_schema;
+}
+
+
 void swap(QDbfRecord &lhs, QDbfRecord &rhs)
 {
     lhs.swap(rhs);
@@ -0,0 +1,178 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include "qdbfrecordview.h"
+#include "qdbfdecoder_p.h"
+
+#include <QByteArray>
+#include <QDate>
+
+const char FIELD_DELETED = 0x2A;        // *
+const char LOGICAL_YES = 0x59;          // Y
+const char LOGICAL_TRUE = 0x54;         // T
+
+
+namespace QDbf {
+
+QDbfRecordView::QDbfRecordView()
+{
+}
+
+
+QDbfRecordView::QDbfRecordView(const char *data, const Internal::QDbfFieldLayout *fields, int count, int index) :
+    m_data(data),
+    m_fields(fields),
+    m_count(count),
+    m_index(index)
+{
+}
+
+
+bool QDbfRecordView::isValid() const
+{
+    return nullptr != m_data;
+}
+
+
+int QDbfRecordView::recordIndex() const
+{
+    return m_index;
+}
+
+
+bool QDbfRecordView::isDeleted() const
+{
+    return nullptr != m_data && FIELD_DELETED == m_data[0];
+}
+
+
+int QDbfRecordView::count() const
+{
+    return m_count;
+}
+
+
+QDbfField::QDbfType QDbfRecordView::type(int fieldIndex) const
+{
+    if (fieldIndex < 0 || fieldIndex >= m_count) {
+        return QDbfField::Undefined;
+    }
+
+    return m_fields[fieldIndex].type;
+}
+
+
+qint32 QDbfRecordView::int32At(int fieldIndex) const
+{
+    if (!isValid() || fieldIndex < 0 || fieldIndex >= m_count) {
+        return 0;
+    }
+
+    const auto &field = m_fields[fieldIndex];
+    const auto data = m_data + field.offset;
+
+    switch (field.type) {
+    case QDbfField::Integer:
+        return Internal::int32FromData(data);
+    case QDbfField::FloatingPoint:
+    case QDbfField::Number:
+    case QDbfField::Currency:
+        return qint32(doubleAt(fieldIndex));
+    case QDbfField::Logical:
+        return boolAt(fieldIndex) ? 1 : 0;
+    default:
+        return 0;
+    }
+}
+
+
+double QDbfRecordView::doubleAt(int fieldIndex) const
+{
+    if (!isValid() || fieldIndex < 0 || fieldIndex >= m_count) {
+        return 0.0;
+    }
+
+    const auto &field = m_fields[fieldIndex];
+    const auto data = m_data + field.offset;
+
+    switch (field.type) {
+    case QDbfField::Integer:
+        return Internal::int32FromData(data);
+    case QDbfField::Currency:
+        return double(Internal::int64FromData(data)) / field.scale;
+    case QDbfField::FloatingPoint:
+    case QDbfField::Number:
+        return Internal::numberFromData(data, field.length, nullptr);
+    default:
+        return 0.0;
+    }
+}
+
+
+bool QDbfRecordView::boolAt(int fieldIndex) const
+{
+    if (!isValid() || fieldIndex < 0 || fieldIndex >= m_count) {
+        return false;
+    }
+
+    const auto &field = m_fields[fieldIndex];
+    if (QDbfField::Logical != field.type) {
+        return false;
+    }
+
+    const auto value = char(m_data[field.offset] & ~0x20);
+    return LOGICAL_TRUE == value || LOGICAL_YES == value;
+}
+
+
+QDate QDbfRecordView::dateAt(int fieldIndex) const
+{
+    if (!isValid() || fieldIndex < 0 || fieldIndex >= m_count) {
+        return {};
+    }
+
+    const auto &field = m_fields[fieldIndex];
+    const auto data = m_data + field.offset;
+
+    switch (field.decoder) {
+    case Internal::DateDecoder:
+    case Internal::DateTimeDecoder:
+        return Internal::dateFromData(data);
+    case Internal::TimestampDecoder:
+        return QDate::fromJulianDay(Internal::int32FromData(data));
+    default:
+        return {};
+    }
+}
+
+
+QByteArray QDbfRecordView::rawAt(int fieldIndex) const
+{
+    if (!isValid() || fieldIndex < 0 || fieldIndex >= m_count) {
+        return QByteArray();
+    }
+
+    const auto &field = m_fields[fieldIndex];
+    return QByteArray::fromRawData(m_data + field.offset, field.length);
+}
+
+} // namespace QDbf
@@ -0,0 +1,137 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#ifndef QDBFSIMD_P_H
+#define QDBFSIMD_P_H
+
+#include <QtGlobal>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define QDBF_SSE2
+#  include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#  define QDBF_AVX2
+#  include <immintrin.h>
+#endif
+
+#if defined(Q_CC_MSVC)
+#  include <intrin.h>
+#endif
+
+
+namespace QDbf {
+namespace Internal {
+
+inline int countTrailingZeroBits(quint32 value)
+{
+    Q_ASSERT(0 != value);
+#if defined(Q_CC_MSVC)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return int(index);
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+
+// Returns the position of the first two consecutive bytes equal to byte, or -1
+inline qint64 indexOfBytePair(const char *data, qint64 length, char byte)
+{
+    qint64 i = 0;
+
+#if defined(QDBF_AVX2)
+    const auto pattern32 = _mm256_set1_epi8(byte);
+    for (; i + 33 <= length; i += 32) {
+        const auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + 1));
+        const auto mask = quint32(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, pattern32),
+                                                                        _mm256_cmpeq_epi8(second, pattern32))));
+        if (0 != mask) {
+            return i + countTrailingZeroBits(mask);
+        }
+    }
+#endif
+
+#if defined(QDBF_SSE2)
+    const auto pattern16 = _mm_set1_epi8(byte);
+    for (; i + 17 <= length; i += 16) {
+        const auto first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const auto second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 1));
+        const auto mask = quint32(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, pattern16),
+                                                                  _mm_cmpeq_epi8(second, pattern16))));
+        if (0 != mask) {
+            return i + countTrailingZeroBits(mask);
+        }
+    }
+#endif
+
+    for (; i + 1 < length; ++i) {
+        if (byte == data[i] && byte == data[i + 1]) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+// Returns the length of the leading run of 7-bit ASCII bytes
+inline qint64 asciiPrefixLength(const char *data, qint64 length)
+{
+    qint64 i = 0;
+
+#if defined(QDBF_AVX2)
+    for (; i + 32 <= length; i += 32) {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const auto mask = quint32(_mm256_movemask_epi8(chunk));
+        if (0 != mask) {
+            return i + countTrailingZeroBits(mask);
+        }
+    }
+#endif
+
+#if defined(QDBF_SSE2)
+    for (; i + 16 <= length; i += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const auto mask = quint32(_mm_movemask_epi8(chunk));
+        if (0 != mask) {
+            return i + countTrailingZeroBits(mask);
+        }
+    }
+#endif
+
+    for (; i < length; ++i) {
+        if (0 != (data[i] & 0x80)) {
+            return i;
+        }
+    }
+
+    return length;
+}
+
+} // namespace Internal
+} // namespace QDbf
+
+#endif // QDBFSIMD_P_H
@@ -21,19 +21,46 @@
 
 #include "qdbffield.h"
 
+#include "qdbfcolumn.h"
+#include "qdbffilter.h"
 #include "qdbfrecord.h"
+#include "qdbfrecordview.h"
 #include "qdbftable.h"
+#include "qdbftable_p.h"
+#include "qdbfcodec_p.h"
+#include "qdbfdecoder_p.h"
+#include "qdbfsimd_p.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <limits>
 
+#include <QBitArray>
+#include <QCache>
 #include <QDataStream>
 #include <QDate>
 #include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
-#include <QTextCodec>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QtEndian>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 const quint16 DBC_LENGTH = 263;
 const quint8 TERMINATOR_LENGTH = 1;
@@ -49,9 +76,15 @@ const quint8 FIELD_DESCRIPTOR_LENGTH = 32;
 const quint8 FIELD_NAME_LENGTH = 10;
 const quint8 FIELD_LENGTH_OFFSET = 16;
 
+// Covers the header of a table with up to 126 fields in a single read
+const qint64 HEADER_READ_LENGTH = 4096;
+
 const quint8 MEMO_BLOCK_LENGTH_OFFSET = 6;
 const quint16 MEMO_DBT_BLOCK_LENGTH = 512;
+const quint8 MEMO_DBT_FIRST_READ_BLOCKS = 4;
+const qint64 MEMO_DBT_MAX_READ_LENGTH = 1024 * 1024;
 const quint8 MEMO_SIGNATURE_TEXT = 1;
+const quint32 MEMO_SIGNATURE_DBASE_IV = 0x0008FFFF; // FF FF 08 00
 
 const quint8 FIELD_TYPE_CHARACTER = 0x43;      // C
 const quint8 FIELD_TYPE_CURRENCY = 0x59;       // Y
@@ -80,25 +113,12 @@ const quint8 LOGICAL_TRUE = 0x54;      // T
 const quint8 LOGICAL_FALSE = 0x46;     // F
 const quint8 FIELD_DELETED = 0x2A;     // *
 const quint8 FIELD_SPACER = 0x20;
+const quint8 RECORD_DELETION_FLAG_LENGTH = 1;
 const quint8 FIELD_NAME_SPACER = 0x00;
 const quint8 END_OF_FILE_MARK = 0x1A;
-const char END_OF_DBASE_MEMO_BLOCK[] = { 0x1A, 0x1A };
+const char END_OF_DBASE_MEMO_BLOCK = 0x1A;
 
 const quint8 DATE_LENGTH = 8;
-const quint8 YEAR_OFFSET = 0;
-const quint8 YEAR_LENGTH = 4;
-const quint8 MONTH_OFFSET = 4;
-const quint8 MONTH_LENGTH = 2;
-const quint8 DAY_OFFSET = 6;
-const quint8 DAY_LENGTH = 2;
-
-const quint8 TIME_LENGTH = 6;
-const quint8 HOUR_OFFSET = 0;
-const quint8 HOUR_LENGTH = 2;
-const quint8 MINUTE_OFFSET = 2;
-const quint8 MINUTE_LENGTH = 2;
-const quint8 SECOND_OFFSET = 4;
-const quint8 SECOND_LENGTH = 2;
 
 const quint8 DATETIME_LENGTH = 14;
 const quint8 DATETIME_DATE_OFFSET = 0;
@@ -107,10 +127,34 @@ const quint8 DATETIME_TIME_OFFSET = 8;
 const quint8 TIMESTAMP_LENGTH = 8;
 const quint8 CURRENCY_BASE = 10;
 
+const int DEFAULT_READ_AHEAD_SIZE = 1024 * 1024;
+const int DEFAULT_MEMO_CACHE_SIZE = 4 * 1024 * 1024;
+const int DEFAULT_SCAN_CHUNK_SIZE = 4 * 1024 * 1024;
+const int DEFAULT_APPEND_BUFFER_SIZE = 4 * 1024 * 1024;
+
 
 namespace QDbf {
 namespace Internal {
 
+struct QDbfPredicate
+{
+    QDbfFilter::Operator op;
+    QDbfFieldLayout field;
+    QVector<QByteArray> bytes;
+    QVector<double> numbers;
+    // The Character range minimum was cut to the field length and is greater than its prefix
+    bool exclusiveMinimum = false;
+};
+
+
+// Distinct values of an interned Character field, the code of a value is its index in values
+struct QDbfDictionary
+{
+    QHash<QByteArray, qint32> codes;
+    QVector<QString> values;
+};
+
+
 class QDbfTablePrivate final
 {
 public:
@@ -130,35 +174,121 @@ public:
 
     void clear();
     bool openMemoFile();
+    void mapFiles();
+    void unmapFiles();
+    const char *recordData(qint32 index) const;
+    bool writeTable(qint64 position, const char *data, int length);
+    void queueWrite(qint64 position, const char *data, int length);
+    bool flushPendingWrites(qint64 position) const;
+    bool flushPendingRecords() const;
+    bool commitBatch();
+    void finishWrites();
+    void markWritten(int recordsCount);
+    bool syncIfDue();
+    bool sync();
+    void invalidateReadAhead() const;
+    bool scanLiveRecords() const;
+    bool bufferRecord() const;
+    void decodeField(int fieldIndex) const;
+    QVariant fieldValue(int fieldIndex) const;
+    QVariant fieldValue(const char *recordData, int fieldIndex) const;
+    bool readRecord(qint32 index, QDbfRecord &record) const;
+    QString internedString(const QDbfFieldLayout &field, const char *data, qint32 *code) const;
+    bool isDeferredMemo(int fieldIndex) const;
+    bool isUnloadedMemo(int fieldIndex, const QVariant &value) const;
     QVariant memoFieldValue(int index) const;
+    QVariant readMemoFieldValue(int index) const;
+    QVariant mappedMemoFieldValue(qint64 position) const;
+    QVariant dBaseMemoFieldValue(qint64 position) const;
     QDataStream::ByteOrder memoByteOrder() const;
     bool setCodepage(QDbfTable::Codepage codepage);
     void setDefaultCodepage(QDbfTable::Codepage codepage);
     bool isValueValid(int i, const QVariant &value) const;
+    bool checkValue(int fieldIndex, const QVariant &value) const;
     void setTextCodec();
+    bool encodeValue(int fieldIndex, const QVariant &value, QByteArray &data, qint32 replacedMemoBlockIndex = -1);
+    qint32 currentMemoBlockIndex(int fieldIndex) const;
+    qint32 memoBlockCount(qint32 memoBlockIndex) const;
+    qint32 allocateMemoBlocks(qint32 memoBlockCount, qint32 replacedMemoBlockIndex);
+    void releaseMemoBlocks(qint32 memoBlockIndex, qint32 memoBlockCount);
+    void finishMemoBlocks(bool written);
+    bool writeMemo(const QByteArray &memoData, qint32 memoBlockIndex);
+    bool writeMemoHeader();
     bool setValue(int fieldIndex, const QVariant &value);
+    bool encodeFields(const QDbfRecord &record, char *data, bool replace);
+    bool encodeRecord(const QDbfRecord &record, QByteArray &buffer);
+    bool writeRecord(const QDbfRecord &record);
+    bool writeRecords(QByteArray &buffer);
+    bool appendRecord(const QDbfRecord &record, QByteArray &buffer);
+    bool flushRecords(QByteArray &buffer);
+    bool writeRecordsCount();
     void setLastUpdate();
+    void setProjection(const QVector<int> &fieldIndexes);
+    void updateLayout();
+    bool compileFilter(const QDbfFilter &filter);
+    bool compilePredicate(const QDbfFilter::Condition &condition, QDbfPredicate &predicate) const;
+    QByteArray comparandBytes(const QDbfFieldLayout &field, const QVariant &value) const;
+    bool matches(const char *data) const;
+    void appendColumnValue(QDbfColumn &column, int row, const char *recordData) const;
 
-    static QDate dateFromByteArray(const QByteArray &byteArray);
-    static QTime timeFromByteArray(const QByteArray &byteArray);
+    static QDbfRecordView recordView(const char *data, const QDbfRecordLayout &layout, int index);
+
+    static qint32 memoBlockIndex(const QByteArray &byteArray, bool *ok);
 
     QString m_tableFileName;
-    QTextCodec *m_textCodec;
+    QDbfCodec m_codec;
     mutable QFile m_tableFile;
     mutable QFile m_memoFile;
+    uchar *m_tableMap = nullptr;
+    uchar *m_memoMap = nullptr;
+    qint64 m_tableMapSize = 0;
+    qint64 m_memoMapSize = 0;
+    mutable QByteArray m_readAheadBuffer;
+    mutable qint32 m_readAheadFirstIndex = 0;
+    mutable qint32 m_readAheadCount = 0;
+    mutable qint32 m_lastReadIndex = BeforeFirstRow;
+    int m_readAheadSize = DEFAULT_READ_AHEAD_SIZE;
+    mutable QCache<qint32, QVariant> m_memoCache;
+    mutable QDbfTable::Statistics m_statistics;
     QDate m_lastUpdate;
     mutable QDbfTable::DbfTableError m_error = QDbfTable::NoError;
     QDbfTable::OpenMode m_openMode = QDbfTable::ReadOnly;
+    QDbfTable::MemoLoading m_memoLoading = QDbfTable::ImmediateMemoLoading;
+    QDbfTable::Durability m_durability = QDbfTable::NoSync;
+    int m_syncRecordsInterval = 0;
+    int m_syncTimeInterval = 0;
+    qint64 m_unsyncedRecords = 0;
+    QElapsedTimer m_syncTimer;
     QDbfMemoType m_memoType = QDbfTablePrivate::NoMemo;
     QDbfTable::Codepage m_codepage = QDbfTable::CodepageNotSet;
     QDbfTable::Codepage m_defaultCodepage = QDbfTable::CodepageNotSet;
     mutable QDbfRecord m_currentRecord;
+    mutable QByteArray m_currentRecordData;
+    mutable QBitArray m_decodedFields;
+    mutable QBitArray m_liveRecords;
+    mutable qint32 m_liveRecordsCount = 0;
+    mutable bool m_liveRecordsValid = false;
     QDbfRecord m_record;
+    QDbfRecord m_tableRecord;
+    QDbfRecordLayout m_layout;
+    bool m_layoutCoversTable = false;
+    QDbfFilter m_filterSource;
+    QVector<QDbfPredicate> m_filter;
+    // Keyed by field offset, which stays the same under any projection
+    mutable QHash<int, QDbfDictionary> m_dictionaries;
     quint16 m_headerLength = 0;
     quint16 m_recordLength = 0;
     quint16 m_fieldsCount = 0;
     qint16 m_memoBlockLength = 0;
     qint32 m_memoNextFreeBlockIndex = 0;
+    QMap<qint32, qint32> m_memoFreeBlocks;
+    // Runs taken and given back by the write in progress, settled by finishMemoBlocks()
+    QVector<QPair<qint32, qint32> > m_allocatedMemoBlocks;
+    QVector<QPair<qint32, qint32> > m_releasedMemoBlocks;
+    bool m_memoHeaderDirty = false;
+    bool m_recordsCountDirty = false;
+    int m_batchDepth = 0;
+    mutable QMap<qint64, QByteArray> m_pendingWrites;
     qint32 m_recordsCount = 0;
     mutable qint32 m_currentIndex = BeforeFirstRow;
     mutable bool m_bufered = false;
@@ -166,15 +296,112 @@ public:
 };
 
 
+struct QDbfScan
+{
+    QString fileName;
+    const char *map = nullptr;
+    const QDbfRecordLayout *layout = nullptr;
+    const QDbfTable::ScanFunction *function = nullptr;
+    QVariant *results = nullptr;
+    qint64 headerLength = 0;
+    qint64 recordLength = 0;
+    int recordsCount = 0;
+    int chunkSize = 0;
+    int chunksCount = 0;
+    QAtomicInt nextChunk;
+    QAtomicInt failed;
+    QSemaphore finished;
+
+    bool hasFailed() const;
+};
+
+
+bool QDbfScan::hasFailed() const
+{
+#if QT_VERSION < 0x050000
+    return 0 != int(failed);
+#else
+    return 0 != failed.loadAcquire();
+#endif
+}
+
+
+class QDbfScanWorker final : public QRunnable
+{
+public:
+    explicit QDbfScanWorker(QDbfScan *scan);
+
+    void run() override;
+
+private:
+    QDbfScan *m_scan;
+};
+
+
+QDbfScanWorker::QDbfScanWorker(QDbfScan *scan) :
+    m_scan(scan)
+{
+    setAutoDelete(false);
+}
+
+
+void QDbfScanWorker::run()
+{
+    // Every worker reads through its own file handle, the mapping is shared
+    QFile file(m_scan->fileName);
+    if (nullptr == m_scan->map && !file.open(QIODevice::ReadOnly)) {
+        m_scan->failed.fetchAndStoreRelease(1);
+        m_scan->finished.release();
+        return;
+    }
+
+    QByteArray buffer;
+    QVector<QDbfRecordView> records;
+    forever {
+        const auto chunk = m_scan->nextChunk.fetchAndAddRelaxed(1);
+        if (chunk >= m_scan->chunksCount || m_scan->hasFailed()) {
+            break;
+        }
+
+        const auto first = chunk * m_scan->chunkSize;
+        const auto count = qMin(m_scan->chunkSize, m_scan->recordsCount - first);
+        const auto position = m_scan->recordLength * first + m_scan->headerLength;
+
+        const char *data = nullptr;
+        if (nullptr != m_scan->map) {
+            data = m_scan->map + position;
+        } else {
+            buffer.resize(int(m_scan->recordLength * count));
+            if (!file.seek(position) || file.read(buffer.data(), buffer.size()) != buffer.size()) {
+                m_scan->failed.fetchAndStoreRelease(1);
+                break;
+            }
+            data = buffer.constData();
+        }
+
+        records.resize(0);
+        records.reserve(count);
+        for (auto i = 0; i < count; ++i) {
+            records.append(QDbfTablePrivate::recordView(data + m_scan->recordLength * i, *m_scan->layout, first + i));
+        }
+
+        m_scan->results[chunk] = (*m_scan->function)(first, records);
+    }
+
+    m_scan->finished.release();
+}
+
+
 QDbfTablePrivate::QDbfTablePrivate(QString &&dbfFileName) :
     m_tableFileName(std::move(dbfFileName)),
-    m_textCodec(QTextCodec::codecForLocale())
+    m_memoCache(DEFAULT_MEMO_CACHE_SIZE)
 {
 }
 
 
 void QDbfTablePrivate::clear()
 {
+    unmapFiles();
     m_error = QDbfTable::NoError;
     m_openMode = QDbfTable::ReadOnly;
     m_dbc = false;
@@ -185,11 +412,33 @@ void QDbfTablePrivate::clear()
     m_fieldsCount = 0;
     m_recordsCount = 0;
     m_memoNextFreeBlockIndex = 0;
+    m_memoFreeBlocks.clear();
+    m_allocatedMemoBlocks.clear();
+    m_releasedMemoBlocks.clear();
+    m_memoHeaderDirty = false;
+    m_recordsCountDirty = false;
+    m_batchDepth = 0;
+    m_pendingWrites.clear();
+    m_unsyncedRecords = 0;
+    m_syncTimer.invalidate();
     m_memoBlockLength = 0;
     m_currentIndex = BeforeFirstRow;
     m_bufered = false;
+    invalidateReadAhead();
+    m_readAheadBuffer.clear();
+    m_memoCache.clear();
     m_currentRecord = QDbfRecord();
+    m_currentRecordData.clear();
+    m_decodedFields.clear();
+    m_liveRecords.clear();
+    m_liveRecordsCount = 0;
+    m_liveRecordsValid = false;
     m_record = QDbfRecord();
+    m_tableRecord = QDbfRecord();
+    m_layout.clear();
+    m_dictionaries.clear();
+    m_filterSource.clear();
+    m_filter.clear();
 }
 
 
@@ -247,431 +496,1875 @@ bool QDbfTablePrivate::openMemoFile()
 }
 
 
-QVariant QDbfTablePrivate::memoFieldValue(int index) const
+void QDbfTablePrivate::mapFiles()
 {
-    Q_ASSERT(m_memoFile.isOpen() && m_memoFile.isReadable());
+    if (QDbfTable::MappedReadOnly != m_openMode) {
+        return;
+    }
 
-    auto position = qint64(m_memoBlockLength) * index;
+    // A failed mapping is not an error: reads fall back to QFile
+    m_tableMapSize = m_tableFile.size();
+    if (0 < m_tableMapSize) {
+        m_tableMap = m_tableFile.map(0, m_tableMapSize);
+    }
 
-    if (QDbfTablePrivate::DBaseMemo == m_memoType) {
-        QByteArray data;
-        forever {
-            if (!m_memoFile.seek(position)) {
-                m_error = QDbfTable::FileReadError;
-                return QVariant::Invalid;
-            }
-            const auto &block = m_memoFile.read(m_memoBlockLength);
-            if (block.isEmpty()) {
-                m_error = QDbfTable::FileReadError;
-                return QVariant::Invalid;
-            }
-            auto endOfBlockPosition = block.indexOf(END_OF_DBASE_MEMO_BLOCK);
-            if (endOfBlockPosition == -1) {
-                data.append(block);
-                position += m_memoBlockLength;
-            } else {
-                data.append(block.left(endOfBlockPosition));
-                break;
-            }
+    if (m_memoFile.isOpen()) {
+        m_memoMapSize = m_memoFile.size();
+        if (0 < m_memoMapSize) {
+            m_memoMap = m_memoFile.map(0, m_memoMapSize);
         }
-        return m_textCodec->toUnicode(data);
     }
+}
 
-    QDataStream stream(&m_memoFile);
-    stream.setByteOrder(memoByteOrder());
-    if (!stream.device()->seek(position)) {
-        m_error = QDbfTable::FileReadError;
-        return QVariant::Invalid;
+
+void QDbfTablePrivate::unmapFiles()
+{
+    if (nullptr != m_tableMap) {
+        m_tableFile.unmap(m_tableMap);
+        m_tableMap = nullptr;
     }
+    m_tableMapSize = 0;
 
-    qint32 signature;
-    stream >> signature;
+    if (nullptr != m_memoMap) {
+        m_memoFile.unmap(m_memoMap);
+        m_memoMap = nullptr;
+    }
+    m_memoMapSize = 0;
+}
 
-    qint32 dataLength;
-    stream >> dataLength;
 
-    const auto &data = m_memoFile.read(dataLength);
-    if (0 < dataLength && data.isEmpty()) {
-        return QVariant::Invalid;
+const char *QDbfTablePrivate::recordData(qint32 index) const
+{
+    if (!flushPendingRecords()) {
+        return nullptr;
     }
 
-    if (MEMO_SIGNATURE_TEXT == signature) {
-        return m_textCodec->toUnicode(data);
+    const auto position = qint64(m_recordLength) * index + m_headerLength;
+
+    if (nullptr != m_tableMap && position + m_recordLength <= m_tableMapSize) {
+        return reinterpret_cast<const char *>(m_tableMap + position);
     }
 
-    m_error = QDbfTable::NoError;
-    return data;
-}
+    const auto sequential = (index == m_lastReadIndex + 1);
+    m_lastReadIndex = index;
+
+    if (m_readAheadFirstIndex <= index && index < m_readAheadFirstIndex + m_readAheadCount) {
+        return m_readAheadBuffer.constData() + (index - m_readAheadFirstIndex) * m_recordLength;
+    }
 
+    invalidateReadAhead();
+    m_lastReadIndex = index;
 
-QDataStream::ByteOrder QDbfTablePrivate::memoByteOrder() const
-{
-    return (m_memoType == QDbfTablePrivate::DBaseIVMemo) ? QDataStream::LittleEndian : QDataStream::BigEndian;
+    if (!m_tableFile.seek(position)) {
+        return nullptr;
+    }
+
+    // Only a forward scan is worth a whole window, random access reads a single record
+    auto windowCount = qMin(m_readAheadSize / qMax<int>(m_recordLength, 1), m_recordsCount - index);
+    if (!sequential || windowCount < 1) {
+        windowCount = 1;
+    }
+
+    m_readAheadBuffer.resize(windowCount * m_recordLength);
+    const auto bytesRead = m_tableFile.read(m_readAheadBuffer.data(), m_readAheadBuffer.size());
+    if (bytesRead < m_recordLength) {
+        return nullptr;
+    }
+
+    m_readAheadFirstIndex = index;
+    m_readAheadCount = qint32(bytesRead / m_recordLength);
+    return m_readAheadBuffer.constData();
 }
 
 
-void QDbfTablePrivate::setDefaultCodepage(QDbfTable::Codepage codepage)
+void QDbfTablePrivate::invalidateReadAhead() const
 {
-    m_defaultCodepage = codepage;
+    m_readAheadFirstIndex = 0;
+    m_readAheadCount = 0;
+    m_lastReadIndex = BeforeFirstRow;
 }
 
 
-bool QDbfTablePrivate::setCodepage(QDbfTable::Codepage codepage)
+// Inside a batch the write is only queued, it reaches the file at commit
+bool QDbfTablePrivate::writeTable(qint64 position, const char *data, int length)
 {
-    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
-        m_error = QDbfTable::FileWriteError;
-        return false;
+    if (m_batchDepth > 0) {
+        queueWrite(position, data, length);
+        return true;
     }
 
-    m_tableFile.seek(CODEPAGE_OFFSET);
-    quint8 byte;
-    switch(codepage) {
-    case QDbfTable::CodepageNotSet:
-        byte = CODEPAGE_NOT_SET;
-        break;
-    case QDbfTable::IBM437:
-        byte = CODEPAGE_US_MSDOS;
-        break;
-    case QDbfTable::IBM850:
-        byte = CODEPAGE_INTERNATIONAL_MSDOD;
-        break;
-    case QDbfTable::IBM866:
-        byte = CODEPAGE_RUSSIAN_OEM;
-        break;
-    case QDbfTable::Windows1250:
-        byte = CODEPAGE_EASTERN_EUROPEAN_WINDOWS;
-        break;
-    case QDbfTable::Windows1251:
-        byte = CODEPAGE_RUSSIAN_WINDOWS;
-        break;
-    case QDbfTable::Windows1252:
-        byte = CODEPAGE_WINDOWS_ANSI_LATIN_1;
-        break;
-    case QDbfTable::GB18030:
-        byte = CODEPAGE_GB18030;
-        break;
-    default:
+    if (!m_tableFile.seek(position)) {
+        m_error = QDbfTable::FileReadError;
         return false;
     }
 
-    if (1 != m_tableFile.write(reinterpret_cast<char *>(&byte), 1)) {
+    invalidateReadAhead();
+
+    if (m_tableFile.write(data, length) != length) {
         m_error = QDbfTable::FileWriteError;
         return false;
     }
 
-    m_codepage = codepage;
-    setTextCodec();
-
-    m_error = QDbfTable::NoError;
     return true;
 }
 
 
-bool QDbfTablePrivate::isValueValid(int i, const QVariant &value) const
+// Overlapping and adjacent writes are merged, so every contiguous span goes out with one write
+void QDbfTablePrivate::queueWrite(qint64 position, const char *data, int length)
 {
-    switch (m_currentRecord.field(i).type()) {
-    case QDbfField::Character:
-        return value.canConvert<QString>();
-    case QDbfField::Date:
-        return value.canConvert<QDate>();
-    case QDbfField::FloatingPoint:
-    case QDbfField::Number:
-    case QDbfField::Currency:
-        return value.canConvert<qreal>();
-    case QDbfField::Logical:
-        return value.canConvert<bool>();
-    case QDbfField::Memo:
-        return m_memoType != QDbfTablePrivate::NoMemo && value.canConvert<QString>();
-    case QDbfField::Integer:
-        return value.canConvert<int>();
-    case QDbfField::DateTime:
-        return value.canConvert<QDateTime>();
-    default:
-        return false;
+    auto first = position;
+    auto last = position + length;
+
+    auto it = m_pendingWrites.upperBound(position);
+    if (it != m_pendingWrites.begin()) {
+        --it;
+        if (it.key() + it.value().size() < position) {
+            ++it;
+        }
+    }
+
+    const auto begin = it;
+    while (it != m_pendingWrites.end() && it.key() <= last) {
+        first = qMin(first, it.key());
+        last = qMax(last, it.key() + it.value().size());
+        ++it;
+    }
+
+    QByteArray span(int(last - first), FIELD_SPACER);
+    for (auto i = begin; i != it;) {
+        const auto &pending = i.value();
+        std::copy(pending.constData(), pending.constData() + pending.size(), span.data() + (i.key() - first));
+        i = m_pendingWrites.erase(i);
     }
+
+    std::copy(data, data + length, span.data() + (position - first));
+    m_pendingWrites.insert(first, span);
 }
 
 
-void QDbfTablePrivate::setTextCodec()
+// Queued writes go out in file order, starting at the given position
+bool QDbfTablePrivate::flushPendingWrites(qint64 position) const
 {
-    switch (m_codepage) {
-    case QDbfTable::Windows1250:
-        m_textCodec = QTextCodec::codecForName("Windows-1250");
-        break;
-    case QDbfTable::Windows1251:
-        m_textCodec = QTextCodec::codecForName("Windows-1251");
-        break;
-    case QDbfTable::Windows1252:
-        m_textCodec = QTextCodec::codecForName("Windows-1252");
-        break;
-    case QDbfTable::IBM850:
-        m_textCodec = QTextCodec::codecForName("IBM 850");
-        break;
-    case QDbfTable::IBM866:
-        m_textCodec = QTextCodec::codecForName("IBM 866");
-        break;
-    case QDbfTable::GB18030:
-        m_textCodec = QTextCodec::codecForName("GB18030");
-        break;
-    default:
-        m_textCodec = QTextCodec::codecForLocale();
-        break;
+    auto it = m_pendingWrites.lowerBound(position);
+    if (it == m_pendingWrites.end()) {
+        return true;
+    }
+
+    invalidateReadAhead();
+
+    while (it != m_pendingWrites.end()) {
+        if (!m_tableFile.seek(it.key())) {
+            m_error = QDbfTable::FileReadError;
+            return false;
+        }
+
+        if (m_tableFile.write(it.value()) != it.value().size()) {
+            m_error = QDbfTable::FileWriteError;
+            return false;
+        }
+
+        it = m_pendingWrites.erase(it);
     }
+
+    return true;
 }
 
 
-QDate QDbfTablePrivate::dateFromByteArray(const QByteArray &byteArray)
+// Reads see queued record writes, the header bookkeeping stays queued until commit
+bool QDbfTablePrivate::flushPendingRecords() const
 {
-    Q_ASSERT(DATE_LENGTH == byteArray.length());
+    if (m_pendingWrites.isEmpty() || m_pendingWrites.lastKey() < m_headerLength) {
+        return true;
+    }
 
-    auto ok = false;
+    return flushPendingWrites(m_headerLength);
+}
 
-    auto y = byteArray.mid(YEAR_OFFSET, YEAR_LENGTH).toInt(&ok);
-    if (!ok) {
-        return {};
-    }
 
-    auto m = byteArray.mid(MONTH_OFFSET, MONTH_LENGTH).toInt(&ok);
-    if (!ok) {
-        return {};
+bool QDbfTablePrivate::commitBatch()
+{
+    if (!writeMemoHeader() || !flushPendingWrites(0) || !syncIfDue()) {
+        return false;
     }
 
-    auto d = byteArray.mid(DAY_OFFSET, DAY_LENGTH).toInt(&ok);
-    if (!ok) {
-        return {};
+    m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+// Commits an unfinished batch and syncs whatever is left when the table goes away
+void QDbfTablePrivate::finishWrites()
+{
+    if (m_batchDepth > 0) {
+        m_batchDepth = 0;
+        commitBatch();
     }
 
-    return { y, m, d };
+    if (QDbfTable::NoSync != m_durability && m_unsyncedRecords > 0) {
+        sync();
+    }
 }
 
 
-QTime QDbfTablePrivate::timeFromByteArray(const QByteArray &byteArray)
+void QDbfTablePrivate::markWritten(int recordsCount)
 {
-    Q_ASSERT(TIME_LENGTH == byteArray.length());
+    if (0 == m_unsyncedRecords) {
+        m_syncTimer.start();
+    }
 
-    auto ok = false;
+    m_unsyncedRecords += recordsCount;
+}
 
-    auto h = byteArray.mid(HOUR_OFFSET, HOUR_LENGTH).toInt(&ok);
-    if (!ok) {
-        return {};
+
+// Every write outside of a batch commits on its own, the periodic intervals are checked as writes come in
+bool QDbfTablePrivate::syncIfDue()
+{
+    if (0 == m_unsyncedRecords || m_batchDepth > 0) {
+        return true;
     }
 
-    auto m = byteArray.mid(MINUTE_OFFSET, MINUTE_LENGTH).toInt(&ok);
-    if (!ok) {
-        return {};
+    switch (m_durability) {
+    case QDbfTable::SyncOnCommit:
+        return sync();
+    case QDbfTable::PeriodicSync:
+        if ((m_syncRecordsInterval > 0 && m_unsyncedRecords >= m_syncRecordsInterval) ||
+            (m_syncTimeInterval > 0 && m_syncTimer.hasExpired(m_syncTimeInterval))) {
+            return sync();
+        }
+        return true;
+    default:
+        return true;
     }
+}
 
-    auto s = byteArray.mid(SECOND_OFFSET, SECOND_LENGTH).toInt(&ok);
-    if (!ok) {
-        return {};
+
+static bool syncFile(QFile &file)
+{
+    if (!file.isOpen() || !file.isWritable()) {
+        return true;
+    }
+
+    if (!file.flush()) {
+        return false;
     }
 
-    return { h, m, s };
+#if defined(Q_OS_WIN)
+    return 0 == ::_commit(file.handle());
+#else
+    return 0 == ::fsync(file.handle());
+#endif
 }
 
 
-bool QDbfTablePrivate::setValue(int fieldIndex, const QVariant &value)
+bool QDbfTablePrivate::sync()
 {
-    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!syncFile(m_tableFile) || !syncFile(m_memoFile)) {
         m_error = QDbfTable::FileWriteError;
         return false;
     }
 
-    if (!m_record.contains(fieldIndex)) {
-        m_error = QDbfTable::InvalidIndexError;
-        return false;
+    const auto elapsed = timer.nsecsElapsed();
+    ++m_statistics.syncCount;
+    m_statistics.syncNsecs += elapsed;
+    m_statistics.maxSyncNsecs = qMax(m_statistics.maxSyncNsecs, elapsed);
+
+    m_unsyncedRecords = 0;
+    m_syncTimer.invalidate();
+    return true;
+}
+
+
+// Only the deletion flag of each record is inspected, no field is decoded
+bool QDbfTablePrivate::scanLiveRecords() const
+{
+    if (m_liveRecordsValid) {
+        return true;
     }
 
-    if (!isValueValid(fieldIndex, value)) {
-        m_error = QDbfTable::InvalidTypeError;
+    if (!flushPendingRecords()) {
         return false;
     }
 
-    QByteArray data;
-    QByteArray memoData;
-    qint32 memoBlockCount = 0;
+    m_liveRecords.fill(false, m_recordsCount);
+    auto count = 0;
 
-    switch (m_record.field(fieldIndex).type()) {
-    case QDbfField::Character:
-        data = m_textCodec->fromUnicode(value.toString()
-                                        .leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true));
+    const auto tableLength = qint64(m_recordLength) * m_recordsCount + m_headerLength;
+    if (nullptr != m_tableMap && tableLength <= m_tableMapSize) {
+        // The flags are a whole record apart, so a plain strided walk is bound by memory, not by compare
+        const auto flags = reinterpret_cast<const char *>(m_tableMap + m_headerLength);
+        for (auto i = 0; i < m_recordsCount; ++i) {
+            if (FIELD_DELETED != quint8(flags[qint64(i) * m_recordLength])) {
+                m_liveRecords.setBit(i);
+                ++count;
+            }
+        }
+    } else {
+        invalidateReadAhead();
+        for (auto i = 0; i < m_recordsCount; ++i) {
+            const auto data = recordData(i);
+            if (nullptr == data) {
+                m_error = QDbfTable::FileReadError;
+                return false;
+            }
+
+            if (FIELD_DELETED != quint8(data[0])) {
+                m_liveRecords.setBit(i);
+                ++count;
+            }
+        }
+    }
+
+    m_liveRecordsCount = count;
+    m_liveRecordsValid = true;
+    return true;
+}
+
+
+QVariant QDbfTablePrivate::mappedMemoFieldValue(qint64 position) const
+{
+    Q_ASSERT(nullptr != m_memoMap);
+
+    if (position < 0 || position >= m_memoMapSize) {
+        m_error = QDbfTable::FileReadError;
+        return QVariant::Invalid;
+    }
+
+    const auto begin = reinterpret_cast<const char *>(m_memoMap + position);
+    const auto available = m_memoMapSize - position;
+
+    if (QDbfTablePrivate::DBaseMemo == m_memoType) {
+        const auto endOfMemoPosition = indexOfBytePair(begin, available, END_OF_DBASE_MEMO_BLOCK);
+        if (endOfMemoPosition == -1 || std::numeric_limits<int>::max() < endOfMemoPosition) {
+            m_error = QDbfTable::FileReadError;
+            return QVariant::Invalid;
+        }
+        m_error = QDbfTable::NoError;
+        return m_codec.toUnicode(begin, int(endOfMemoPosition));
+    }
+
+    const qint64 memoHeaderLength = 2 * sizeof(qint32);
+    if (available < memoHeaderLength) {
+        m_error = QDbfTable::FileReadError;
+        return QVariant::Invalid;
+    }
+
+    const auto header = reinterpret_cast<const uchar *>(begin);
+    const auto bigEndian = (QDataStream::BigEndian == memoByteOrder());
+    const auto signature = bigEndian ? qFromBigEndian<qint32>(header) : qFromLittleEndian<qint32>(header);
+    const auto dataLength = bigEndian ? qFromBigEndian<qint32>(header + sizeof(qint32))
+                                      : qFromLittleEndian<qint32>(header + sizeof(qint32));
+
+    if (dataLength < 0 || available - memoHeaderLength < dataLength) {
+        return QVariant::Invalid;
+    }
+
+    if (MEMO_SIGNATURE_TEXT == signature) {
+        return m_codec.toUnicode(begin + memoHeaderLength, dataLength);
+    }
+
+    m_error = QDbfTable::NoError;
+    return QByteArray(begin + memoHeaderLength, dataLength);
+}
+
+
+QVariant QDbfTablePrivate::memoFieldValue(int index) const
+{
+    if (0 == m_memoCache.maxCost()) {
+        return readMemoFieldValue(index);
+    }
+
+    if (const auto cachedValue = m_memoCache.object(index)) {
+        ++m_statistics.memoCacheHits;
+        return *cachedValue;
+    }
+    ++m_statistics.memoCacheMisses;
+
+    const auto &value = readMemoFieldValue(index);
+    if (value.isValid()) {
+        const auto cost = (QVariant::String == value.type()) ? value.toString().size() * int(sizeof(QChar))
+                                                             : value.toByteArray().size();
+        m_memoCache.insert(index, new QVariant(value), qMax(cost, 1));
+    }
+
+    return value;
+}
+
+
+QVariant QDbfTablePrivate::readMemoFieldValue(int index) const
+{
+    Q_ASSERT(m_memoFile.isOpen() && m_memoFile.isReadable());
+
+    auto position = qint64(m_memoBlockLength) * index;
+
+    if (nullptr != m_memoMap) {
+        return mappedMemoFieldValue(position);
+    }
+
+    if (QDbfTablePrivate::DBaseMemo == m_memoType) {
+        return dBaseMemoFieldValue(position);
+    }
+
+    QDataStream stream(&m_memoFile);
+    stream.setByteOrder(memoByteOrder());
+    if (!stream.device()->seek(position)) {
+        m_error = QDbfTable::FileReadError;
+        return QVariant::Invalid;
+    }
+
+    qint32 signature;
+    stream >> signature;
+
+    qint32 dataLength;
+    stream >> dataLength;
+
+    const auto &data = m_memoFile.read(dataLength);
+    if (0 < dataLength && data.isEmpty()) {
+        return QVariant::Invalid;
+    }
+
+    if (MEMO_SIGNATURE_TEXT == signature) {
+        return m_codec.toUnicode(data);
+    }
+
+    m_error = QDbfTable::NoError;
+    return data;
+}
+
+
+QVariant QDbfTablePrivate::dBaseMemoFieldValue(qint64 position) const
+{
+    if (!m_memoFile.seek(position)) {
+        m_error = QDbfTable::FileReadError;
+        return QVariant::Invalid;
+    }
+
+    // Read a few blocks first and grow the chunk for long memos,
+    // the end of memo mark is searched in the data read so far
+    QByteArray data;
+    auto chunkLength = qint64(m_memoBlockLength) * MEMO_DBT_FIRST_READ_BLOCKS;
+    auto searchPosition = 0;
+    forever {
+        const auto dataLength = data.size();
+        if (std::numeric_limits<int>::max() - dataLength < chunkLength) {
+            m_error = QDbfTable::FileReadError;
+            return QVariant::Invalid;
+        }
+
+        data.resize(dataLength + int(chunkLength));
+        const auto bytesRead = m_memoFile.read(data.data() + dataLength, chunkLength);
+        if (bytesRead <= 0) {
+            m_error = QDbfTable::FileReadError;
+            return QVariant::Invalid;
+        }
+        data.resize(dataLength + int(bytesRead));
+
+        const auto endOfMemoPosition = indexOfBytePair(data.constData() + searchPosition,
+                                                       data.size() - searchPosition, END_OF_DBASE_MEMO_BLOCK);
+        if (endOfMemoPosition != -1) {
+            return m_codec.toUnicode(data.constData(), searchPosition + int(endOfMemoPosition));
+        }
+
+        searchPosition = data.size() - 1;
+        chunkLength = qMin(chunkLength * 2, MEMO_DBT_MAX_READ_LENGTH);
+    }
+}
+
+
+QDataStream::ByteOrder QDbfTablePrivate::memoByteOrder() const
+{
+    return (m_memoType == QDbfTablePrivate::DBaseIVMemo) ? QDataStream::LittleEndian : QDataStream::BigEndian;
+}
+
+
+void QDbfTablePrivate::setDefaultCodepage(QDbfTable::Codepage codepage)
+{
+    m_defaultCodepage = codepage;
+}
+
+
+bool QDbfTablePrivate::setCodepage(QDbfTable::Codepage codepage)
+{
+    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    m_tableFile.seek(CODEPAGE_OFFSET);
+    quint8 byte;
+    switch(codepage) {
+    case QDbfTable::CodepageNotSet:
+        byte = CODEPAGE_NOT_SET;
         break;
-    case QDbfField::Currency: {
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::LittleEndian);
-        stream << qint64(value.toReal() * std::pow(CURRENCY_BASE, m_record.field(fieldIndex).precision()));
+    case QDbfTable::IBM437:
+        byte = CODEPAGE_US_MSDOS;
+        break;
+    case QDbfTable::IBM850:
+        byte = CODEPAGE_INTERNATIONAL_MSDOD;
+        break;
+    case QDbfTable::IBM866:
+        byte = CODEPAGE_RUSSIAN_OEM;
+        break;
+    case QDbfTable::Windows1250:
+        byte = CODEPAGE_EASTERN_EUROPEAN_WINDOWS;
+        break;
+    case QDbfTable::Windows1251:
+        byte = CODEPAGE_RUSSIAN_WINDOWS;
         break;
+    case QDbfTable::Windows1252:
+        byte = CODEPAGE_WINDOWS_ANSI_LATIN_1;
+        break;
+    case QDbfTable::GB18030:
+        byte = CODEPAGE_GB18030;
+        break;
+    default:
+        return false;
     }
+
+    if (1 != m_tableFile.write(reinterpret_cast<char *>(&byte), 1)) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    m_codepage = codepage;
+    setTextCodec();
+
+    m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+bool QDbfTablePrivate::isValueValid(int i, const QVariant &value) const
+{
+    switch (m_currentRecord.field(i).type()) {
+    case QDbfField::Character:
+        return value.canConvert<QString>();
     case QDbfField::Date:
-        data = value.toDate().toString(QLatin1String("yyyyMMdd"))
-               .leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
-        break;
+        return value.canConvert<QDate>();
     case QDbfField::FloatingPoint:
     case QDbfField::Number:
-        data = QString::number(value.toReal(), 'f', m_record.field(fieldIndex).precision())
-               .rightJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
-        break;
+    case QDbfField::Currency:
+        return value.canConvert<qreal>();
     case QDbfField::Logical:
-        data = QByteArray(1, value.toBool() ? LOGICAL_TRUE : LOGICAL_FALSE);
+        return value.canConvert<bool>();
+    case QDbfField::Memo:
+        return m_memoType != QDbfTablePrivate::NoMemo && value.canConvert<QString>();
+    case QDbfField::Integer:
+        return value.canConvert<int>();
+    case QDbfField::DateTime:
+        return value.canConvert<QDateTime>();
+    default:
+        return false;
+    }
+}
+
+
+// Everything encodeValue() can reject is rejected here, before any memo block is touched
+bool QDbfTablePrivate::checkValue(int fieldIndex, const QVariant &value) const
+{
+    if (!isValueValid(fieldIndex, value)) {
+        m_error = QDbfTable::InvalidTypeError;
+        return false;
+    }
+
+    const auto &field = m_record.field(fieldIndex);
+    switch (field.type()) {
+    case QDbfField::Memo:
+        if (!value.toString().isEmpty() && 10 != field.length() && 4 != field.length()) {
+            m_error = QDbfTable::UnsupportedFile;
+            return false;
+        }
+        break;
+    case QDbfField::DateTime: {
+        const auto &val = value.toDateTime();
+        if (!val.isValid()) {
+            m_error = QDbfTable::InvalidValue;
+            return false;
+        }
+
+        if (DATETIME_LENGTH != field.length() && TIMESTAMP_LENGTH != field.length()) {
+            m_error = QDbfTable::UnsupportedFile;
+            return false;
+        }
+
+        if (TIMESTAMP_LENGTH == field.length() && std::numeric_limits<qint32>::max() < val.date().toJulianDay()) {
+            m_error = QDbfTable::InvalidValue;
+            return false;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    return true;
+}
+
+
+// Everything decoded with the previous codec is dropped
+void QDbfTablePrivate::setTextCodec()
+{
+    m_codec.setCodepage(m_codepage);
+    m_memoCache.clear();
+    m_bufered = false;
+
+    const auto &offsets = m_dictionaries.keys();
+    for (auto i = 0; i < offsets.size(); ++i) {
+        m_dictionaries[offsets.at(i)] = QDbfDictionary();
+    }
+
+    if (!m_filter.isEmpty()) {
+        compileFilter(m_filterSource);
+    }
+}
+
+
+bool QDbfTablePrivate::bufferRecord() const
+{
+    if (m_bufered) {
+        return true;
+    }
+
+    m_currentRecord = m_record;
+    m_decodedFields.fill(false, m_record.count());
+
+    if (m_currentIndex < QDbfTablePrivate::FirstRow) {
+        return false;
+    }
+
+    if (!m_tableFile.isOpen()) {
+        m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    const auto data = recordData(m_currentIndex);
+    if (nullptr == data) {
+        m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    // Keep an owned copy, the window and the mapping may go away before all fields are decoded
+    m_currentRecordData.resize(m_recordLength);
+    std::copy(data, data + m_recordLength, m_currentRecordData.data());
+
+    m_currentRecord.setRecordIndex(m_currentIndex);
+    m_currentRecord.setDeleted(FIELD_DELETED == data[0]);
+    m_bufered = true;
+    return true;
+}
+
+
+qint32 QDbfTablePrivate::memoBlockIndex(const QByteArray &byteArray, bool *ok)
+{
+    *ok = false;
+
+    if (10 == byteArray.length()) {
+        if (byteArray.trimmed().isEmpty()) {
+            *ok = true;
+            return -1;
+        }
+        return QString::fromLatin1(byteArray).toInt(ok);
+    }
+
+    if (4 == byteArray.length()) {
+        *ok = true;
+        return qFromLittleEndian<qint32>(reinterpret_cast<const uchar *>(byteArray.constData()));
+    }
+
+    return -1;
+}
+
+
+void QDbfTablePrivate::decodeField(int fieldIndex) const
+{
+    Q_ASSERT(m_bufered);
+
+    if (m_decodedFields.testBit(fieldIndex)) {
+        return;
+    }
+
+    m_currentRecord.setValue(fieldIndex, fieldValue(fieldIndex));
+    m_decodedFields.setBit(fieldIndex);
+}
+
+
+bool QDbfTablePrivate::isDeferredMemo(int fieldIndex) const
+{
+    return QDbfTable::DeferredMemoLoading == m_memoLoading &&
+           MemoDecoder == m_layout.at(fieldIndex).decoder;
+}
+
+
+// A deferred memo that was never loaded is an invalid value, unlike an empty memo
+bool QDbfTablePrivate::isUnloadedMemo(int fieldIndex, const QVariant &value) const
+{
+    return MemoDecoder == m_layout.at(fieldIndex).decoder && !value.isValid();
+}
+
+
+QVariant QDbfTablePrivate::fieldValue(int fieldIndex) const
+{
+    return fieldValue(m_currentRecordData.constData(), fieldIndex);
+}
+
+
+QVariant QDbfTablePrivate::fieldValue(const char *recordData, int fieldIndex) const
+{
+    const auto &field = m_layout.at(fieldIndex);
+    const auto data = recordData + field.offset;
+
+    switch (field.decoder) {
+    case CharacterDecoder: {
+        if (field.interned) {
+            qint32 code;
+            return internedString(field, data, &code);
+        }
+        return m_codec.toUnicode(data, field.length);
+    }
+    case CurrencyDecoder:
+        return qreal(int64FromData(data)) / field.scale;
+    case DateDecoder:
+        return QVariant(dateFromData(data));
+    case IntegralNumberDecoder:
+        // A blank or malformed numeral reads as zero, as it always has
+        return integerFromData(data, field.length, nullptr);
+    case DecimalNumberDecoder:
+        return numberFromData(data, field.length, nullptr);
+    case LogicalDecoder:
+        if (LOGICAL_UNDEFINED == quint8(data[0])) {
+            return QVariant(QVariant::Bool);
+        }
+
+        switch (quint8(data[0] & ~0x20)) {
+        case LOGICAL_TRUE:
+        case LOGICAL_YES:
+            return true;
+        case LOGICAL_FALSE:
+        case LOGICAL_NO:
+            return false;
+        default:
+            return QVariant::Invalid;
+        }
+    case MemoDecoder: {
+        auto ok = false;
+        const auto index = memoBlockIndex(QByteArray::fromRawData(data, field.length), &ok);
+        if (m_memoType == QDbfTablePrivate::NoMemo || !ok) {
+            return QVariant::Invalid;
+        }
+        if (index < 0) {
+            return QVariant::String;
+        }
+        return memoFieldValue(index);
+    }
+    case IntegerDecoder:
+        return int32FromData(data);
+    case DateTimeDecoder: {
+        auto ok = false;
+        const auto &date = dateFromData(data + DATETIME_DATE_OFFSET);
+        const auto msecs = millisecondsFromData(data + DATETIME_TIME_OFFSET, &ok);
+#if QT_VERSION < 0x050200
+        const auto &time = ok ? QTime(0, 0, 0, 0).addMSecs(msecs) : QTime();
+#else
+        const auto &time = ok ? QTime::fromMSecsSinceStartOfDay(msecs) : QTime();
+#endif
+        return QVariant(QDateTime(date, time));
+    }
+    case TimestampDecoder: {
+        const auto &date = QDate::fromJulianDay(int32FromData(data));
+        const auto msecs = int32FromData(data + sizeof(qint32));
+#if QT_VERSION < 0x050200
+        const auto &time = QTime(0, 0, 0, 0).addMSecs(msecs);
+#else
+        const auto &time = QTime::fromMSecsSinceStartOfDay(msecs);
+#endif
+        return QVariant(QDateTime(date, time));
+    }
+    default:
+        return QVariant::Invalid;
+    }
+}
+
+
+// Repeated values come back as copies of one implicitly shared QString
+QString QDbfTablePrivate::internedString(const QDbfFieldLayout &field, const char *data, qint32 *code) const
+{
+    auto &dictionary = m_dictionaries[field.offset];
+
+    const auto it = dictionary.codes.constFind(QByteArray::fromRawData(data, field.length));
+    if (it != dictionary.codes.constEnd()) {
+        *code = it.value();
+        return dictionary.values.at(*code);
+    }
+
+    const auto &value = m_codec.toUnicode(data, field.length);
+    *code = dictionary.values.size();
+    dictionary.codes.insert(QByteArray(data, field.length), *code);
+    dictionary.values.append(value);
+    return value;
+}
+
+
+// Decodes straight from the window or the mapping into the caller's record, reusing its value storage
+bool QDbfTablePrivate::readRecord(qint32 index, QDbfRecord &record) const
+{
+    const auto data = recordData(index);
+    if (nullptr == data) {
+        m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    if (!record.sharesSchema(m_record)) {
+        record = m_record;
+    }
+
+    record.setRecordIndex(index);
+    record.setDeleted(FIELD_DELETED == data[0]);
+    for (auto i = 0; i < m_layout.size(); ++i) {
+        record.setValue(i, isDeferredMemo(i) ? QVariant() : fieldValue(data, i));
+    }
+
+    return true;
+}
+
+
+// Encodes a value into its on-disk field bytes, a memo value is written to the memo file on the way
+// The value has been through checkValue(), memo blocks it takes or gives back
+// are recorded for finishMemoBlocks()
+bool QDbfTablePrivate::encodeValue(int fieldIndex, const QVariant &value, QByteArray &data,
+                                   qint32 replacedMemoBlockIndex)
+{
+    data.clear();
+    QByteArray memoData;
+    qint32 memoBlockIndex = -1;
+
+    switch (m_record.field(fieldIndex).type()) {
+    case QDbfField::Character:
+        data = m_codec.fromUnicode(value.toString()
+                                        .leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true));
+        break;
+    case QDbfField::Currency: {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << qint64(value.toReal() * m_layout.at(fieldIndex).scale);
+        break;
+    }
+    case QDbfField::Date:
+        data = value.toDate().toString(QLatin1String("yyyyMMdd"))
+               .leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
+        break;
+    case QDbfField::FloatingPoint:
+    case QDbfField::Number:
+        data = QString::number(value.toReal(), 'f', m_record.field(fieldIndex).precision())
+               .rightJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
+        break;
+    case QDbfField::Logical:
+        data = QByteArray(1, value.toBool() ? LOGICAL_TRUE : LOGICAL_FALSE);
+        break;
+    case QDbfField::Memo: {
+        const auto &val = m_codec.fromUnicode(value.toString());
+        if (val.isEmpty()) {
+            m_releasedMemoBlocks.append(qMakePair(replacedMemoBlockIndex, memoBlockCount(replacedMemoBlockIndex)));
+            data = QString().rightJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
+        } else {
+            switch (m_memoType) {
+            case Internal::QDbfTablePrivate::DBaseIVMemo:
+            case Internal::QDbfTablePrivate::FoxProMemo: {
+                QDataStream stream(&memoData, QIODevice::WriteOnly);
+                stream.setByteOrder(memoByteOrder());
+                auto signature = quint32(MEMO_SIGNATURE_TEXT);
+                stream << signature;
+                auto valLength = qint32(val.length());
+                stream << valLength;
+            }
+            case Internal::QDbfTablePrivate::DBaseMemo:
+                memoData.append(val);
+                break;
+            default:
+                m_error = QDbfTable::UnsupportedFile;
+                return false;
+            }
+
+            const auto length = m_record.field(fieldIndex).length();
+            const auto blockCount = memoData.length() / m_memoBlockLength + (0 < (memoData.length() % m_memoBlockLength) ? 1 : 0);
+            memoBlockIndex = allocateMemoBlocks(blockCount, replacedMemoBlockIndex);
+
+            if (10 == length) {
+                data = QString::number(memoBlockIndex)
+                       .rightJustified(length, QLatin1Char(FIELD_SPACER), true).toLatin1();
+            } else {
+                QDataStream stream(&data, QIODevice::WriteOnly);
+                stream.setByteOrder(QDataStream::LittleEndian);
+                stream << memoBlockIndex;
+            }
+        }
+        break;
+    }
+    case QDbfField::Integer: {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        auto val = qint32(value.toInt());
+        stream << val;
+        break;
+    }
+    case QDbfField::DateTime: {
+        const auto &val = value.toDateTime();
+        if (DATETIME_LENGTH == m_record.field(fieldIndex).length()) {
+            data = val.toString(QLatin1String("yyyyMMddHHmmss"))
+                   .leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
+        } else {
+            const auto day = qint32(val.date().toJulianDay());
+#if QT_VERSION < 0x050200
+            auto msecs = QTime(0, 0, 0, 0).msecsTo(val.time());
+#else
+            auto msecs = val.time().msecsSinceStartOfDay();
+#endif
+            QDataStream stream(&data, QIODevice::WriteOnly);
+            stream.setByteOrder(QDataStream::LittleEndian);
+            stream << day;
+            stream << msecs;
+        }
+        break;
+    }
+    default:
+        data = QString().leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
+        break;
+    }
+
+    if (0 < memoBlockIndex && !writeMemo(memoData, memoBlockIndex)) {
+        return false;
+    }
+
+    return true;
+}
+
+
+// Block index the current record refers to for a memo field, -1 when there is none
+qint32 QDbfTablePrivate::currentMemoBlockIndex(int fieldIndex) const
+{
+    const auto &field = m_layout.at(fieldIndex);
+    if (MemoDecoder != field.decoder || m_currentIndex < FirstRow || m_currentIndex >= m_recordsCount) {
+        return -1;
+    }
+
+    const auto data = recordData(m_currentIndex);
+    if (nullptr == data) {
+        return -1;
+    }
+
+    auto ok = false;
+    const auto index = memoBlockIndex(QByteArray::fromRawData(data + field.offset, field.length), &ok);
+    return ok ? index : -1;
+}
+
+
+// Only memos with a length header can be measured, dBase III memos are never reused.
+// dBase IV counts its own 8 byte header in the length, FoxPro and memos written here do not
+qint32 QDbfTablePrivate::memoBlockCount(qint32 memoBlockIndex) const
+{
+    if (memoBlockIndex <= 0 || memoBlockIndex >= m_memoNextFreeBlockIndex || 0 >= m_memoBlockLength ||
+        (DBaseIVMemo != m_memoType && FoxProMemo != m_memoType)) {
+        return 0;
+    }
+
+    const auto position = qint64(m_memoBlockLength) * memoBlockIndex;
+    const qint64 memoHeaderLength = 2 * sizeof(qint32);
+
+    QByteArray header;
+    if (nullptr != m_memoMap && position + memoHeaderLength <= m_memoMapSize) {
+        header = QByteArray::fromRawData(reinterpret_cast<const char *>(m_memoMap + position), memoHeaderLength);
+    } else if (m_memoFile.seek(position)) {
+        header = m_memoFile.read(memoHeaderLength);
+    }
+
+    if (header.size() < memoHeaderLength) {
+        return 0;
+    }
+
+    const auto data = reinterpret_cast<const uchar *>(header.constData());
+    const auto bigEndian = (QDataStream::BigEndian == memoByteOrder());
+    const auto signature = bigEndian ? qFromBigEndian<quint32>(data) : qFromLittleEndian<quint32>(data);
+    const auto dataLength = bigEndian ? qFromBigEndian<qint32>(data + sizeof(qint32))
+                                      : qFromLittleEndian<qint32>(data + sizeof(qint32));
+    if (dataLength < 0) {
+        return 0;
+    }
+
+    qint64 chainLength = memoHeaderLength + dataLength;
+    if (DBaseIVMemo == m_memoType) {
+        if (MEMO_SIGNATURE_DBASE_IV == signature) {
+            chainLength = qMax<qint64>(dataLength, memoHeaderLength);
+        } else if (MEMO_SIGNATURE_TEXT != signature) {
+            return 0;
+        }
+    }
+
+    const auto blockCount = qint32((chainLength + m_memoBlockLength - 1) / m_memoBlockLength);
+    return (memoBlockIndex + blockCount <= m_memoNextFreeBlockIndex) ? blockCount : 0;
+}
+
+
+// The replaced chain is overwritten in place when the memo fits, otherwise the first
+// freed run that is long enough is taken and the file only grows when there is none
+qint32 QDbfTablePrivate::allocateMemoBlocks(qint32 memoBlockCount, qint32 replacedMemoBlockIndex)
+{
+    const auto replacedBlockCount = this->memoBlockCount(replacedMemoBlockIndex);
+    if (memoBlockCount <= replacedBlockCount) {
+        m_releasedMemoBlocks.append(qMakePair(replacedMemoBlockIndex + memoBlockCount,
+                                              replacedBlockCount - memoBlockCount));
+        return replacedMemoBlockIndex;
+    }
+
+    // The replaced chain stays taken until the record no longer refers to it
+    m_releasedMemoBlocks.append(qMakePair(replacedMemoBlockIndex, replacedBlockCount));
+
+    auto index = m_memoNextFreeBlockIndex;
+    auto it = m_memoFreeBlocks.begin();
+    while (it != m_memoFreeBlocks.end() && it.value() < memoBlockCount) {
+        ++it;
+    }
+
+    if (it != m_memoFreeBlocks.end()) {
+        index = it.key();
+        const auto remainingCount = it.value() - memoBlockCount;
+        m_memoFreeBlocks.erase(it);
+        if (0 < remainingCount) {
+            m_memoFreeBlocks.insert(index + memoBlockCount, remainingCount);
+        }
+    } else {
+        m_memoNextFreeBlockIndex += memoBlockCount;
+        m_memoHeaderDirty = true;
+    }
+
+    m_allocatedMemoBlocks.append(qMakePair(index, memoBlockCount));
+    return index;
+}
+
+
+// Adjacent runs are merged, a run at the end of the file moves the next free block back
+void QDbfTablePrivate::releaseMemoBlocks(qint32 memoBlockIndex, qint32 memoBlockCount)
+{
+    if (memoBlockIndex <= 0 || memoBlockCount <= 0) {
+        return;
+    }
+
+    auto next = m_memoFreeBlocks.lowerBound(memoBlockIndex);
+    if (next != m_memoFreeBlocks.end() && next.key() == memoBlockIndex + memoBlockCount) {
+        memoBlockCount += next.value();
+        next = m_memoFreeBlocks.erase(next);
+    }
+
+    if (next != m_memoFreeBlocks.begin()) {
+        auto previous = next;
+        --previous;
+        if (previous.key() + previous.value() == memoBlockIndex) {
+            memoBlockIndex = previous.key();
+            memoBlockCount += previous.value();
+            m_memoFreeBlocks.erase(previous);
+        }
+    }
+
+    if (memoBlockIndex + memoBlockCount == m_memoNextFreeBlockIndex) {
+        m_memoNextFreeBlockIndex = memoBlockIndex;
+        m_memoHeaderDirty = true;
+        return;
+    }
+
+    m_memoFreeBlocks.insert(memoBlockIndex, memoBlockCount);
+}
+
+
+// Once the record is written the blocks it gave back become free, when it was
+// not the blocks taken for it are freed again and the old memos stay as they were
+void QDbfTablePrivate::finishMemoBlocks(bool written)
+{
+    const auto &blocks = written ? m_releasedMemoBlocks : m_allocatedMemoBlocks;
+    for (auto i = 0; i < blocks.size(); ++i) {
+        releaseMemoBlocks(blocks.at(i).first, blocks.at(i).second);
+    }
+
+    m_allocatedMemoBlocks.clear();
+    m_releasedMemoBlocks.clear();
+}
+
+
+bool QDbfTablePrivate::writeMemo(const QByteArray &memoData, qint32 memoBlockIndex)
+{
+    Q_ASSERT(0 < memoData.length() && 0 < memoBlockIndex);
+
+    if (!m_memoFile.isOpen() || !m_memoFile.isWritable()) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    auto position = qint64(m_memoBlockLength) * memoBlockIndex;
+    if (!m_memoFile.seek(position)) {
+        m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    if (m_memoFile.write(memoData) != memoData.length()) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    m_memoCache.clear();
+    return true;
+}
+
+
+// The next free block index goes out once per record or edit, however many memos were written
+bool QDbfTablePrivate::writeMemoHeader()
+{
+    if (!m_memoHeaderDirty || m_batchDepth > 0) {
+        return true;
+    }
+
+    QDataStream stream(&m_memoFile);
+    stream.setByteOrder(memoByteOrder());
+    if (!stream.device()->seek(0)) {
+        m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    stream << m_memoNextFreeBlockIndex;
+    m_memoHeaderDirty = false;
+    return true;
+}
+
+
+bool QDbfTablePrivate::setValue(int fieldIndex, const QVariant &value)
+{
+    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    if (!m_record.contains(fieldIndex)) {
+        m_error = QDbfTable::InvalidIndexError;
+        return false;
+    }
+
+    if (!checkValue(fieldIndex, value)) {
+        return false;
+    }
+
+    auto position = qint64(m_recordLength) * m_currentIndex +
+                    m_headerLength + m_record.field(fieldIndex).offset();
+
+    QByteArray data;
+    if (!encodeValue(fieldIndex, value, data, currentMemoBlockIndex(fieldIndex)) || !writeMemoHeader() ||
+        !writeTable(position, data.constData(), data.size())) {
+        finishMemoBlocks(false);
+        writeMemoHeader();
+        return false;
+    }
+
+    finishMemoBlocks(true);
+    if (!writeMemoHeader()) {
+        return false;
+    }
+
+    m_currentRecord.setValue(fieldIndex, value);
+    if (m_bufered) {
+        m_decodedFields.setBit(fieldIndex);
+    }
+    m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+// A replaced record hands its memo blocks over to the new values and keeps the pointers
+// of memos that were never loaded, an appended copy loads them from its source record.
+// Every value is checked first, so a rejected record leaves the memo file alone
+bool QDbfTablePrivate::encodeFields(const QDbfRecord &record, char *data, bool replace)
+{
+    const auto count = qMin(record.count(), m_layout.size());
+    for (auto i = 0; i < count; ++i) {
+        const auto &value = record.value(i);
+        if (!isUnloadedMemo(i, value) && !checkValue(i, value)) {
+            return false;
+        }
+    }
+
+    QByteArray bytes;
+    for (auto i = 0; i < count; ++i) {
+        auto value = record.value(i);
+        if (isUnloadedMemo(i, value)) {
+            if (replace) {
+                continue;
+            }
+
+            const auto index = record.recordIndex();
+            const auto source = (FirstRow <= index && index < m_recordsCount) ? recordData(index) : nullptr;
+            value = (nullptr != source) ? fieldValue(source, i) : QVariant(QString());
+            if (!value.isValid()) {
+                m_error = QDbfTable::FileReadError;
+                return false;
+            }
+        }
+
+        const auto replacedMemoBlockIndex = replace ? currentMemoBlockIndex(i) : -1;
+        if (!encodeValue(i, value, bytes, replacedMemoBlockIndex)) {
+            return false;
+        }
+
+        const auto &field = m_layout.at(i);
+        std::copy(bytes.constData(), bytes.constData() + qMin(bytes.size(), field.length),
+                  data + field.offset);
+    }
+
+    return true;
+}
+
+
+// Appends a whole record, deletion flag included, to the end of the buffer
+bool QDbfTablePrivate::encodeRecord(const QDbfRecord &record, QByteArray &buffer)
+{
+    const auto size = buffer.size();
+    buffer.resize(size + m_recordLength);
+
+    auto data = buffer.data() + size;
+    std::fill(data, data + m_recordLength, char(FIELD_SPACER));
+    if (record.isDeleted()) {
+        data[0] = char(FIELD_DELETED);
+    }
+
+    if (!encodeFields(record, data, false)) {
+        finishMemoBlocks(false);
+        buffer.resize(size);
+        return false;
+    }
+
+    finishMemoBlocks(true);
+    return true;
+}
+
+
+// Encodes every field into one buffer and writes the record with a single write
+bool QDbfTablePrivate::writeRecord(const QDbfRecord &record)
+{
+    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    if (m_currentIndex < FirstRow || m_currentIndex >= m_recordsCount) {
+        m_error = QDbfTable::InvalidIndexError;
+        return false;
+    }
+
+    // Fields the record does not carry keep their bytes, so they are read back first
+    const auto count = qMin(record.count(), m_layout.size());
+    auto complete = m_layoutCoversTable && m_layout.size() <= record.count();
+    for (auto i = 0; complete && i < count; ++i) {
+        complete = !isUnloadedMemo(i, record.value(i));
+    }
+
+    QByteArray buffer;
+    if (complete) {
+        buffer.fill(FIELD_SPACER, m_recordLength);
+    } else {
+        const auto data = recordData(m_currentIndex);
+        if (nullptr == data) {
+            m_error = QDbfTable::FileReadError;
+            return false;
+        }
+        buffer = QByteArray(data, m_recordLength);
+    }
+
+    // The deletion flag is left as it is. Blocks of the replaced memos are only
+    // freed once the record refers to their successors
+    const auto position = qint64(m_recordLength) * m_currentIndex + m_headerLength + RECORD_DELETION_FLAG_LENGTH;
+    if (!encodeFields(record, buffer.data(), true) || !writeMemoHeader() ||
+        !writeTable(position, buffer.constData() + RECORD_DELETION_FLAG_LENGTH,
+                    m_recordLength - RECORD_DELETION_FLAG_LENGTH)) {
+        finishMemoBlocks(false);
+        writeMemoHeader();
+        return false;
+    }
+
+    finishMemoBlocks(true);
+    if (!writeMemoHeader()) {
+        return false;
+    }
+
+    for (auto i = 0; i < count; ++i) {
+        if (isUnloadedMemo(i, record.value(i))) {
+            continue;
+        }
+
+        m_currentRecord.setValue(i, record.value(i));
+        if (m_bufered) {
+            m_decodedFields.setBit(i);
+        }
+    }
+
+    m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+// Writes the encoded records after the last one, the end of file mark goes out with them
+bool QDbfTablePrivate::writeRecords(QByteArray &buffer)
+{
+    if (buffer.isEmpty()) {
+        return true;
+    }
+
+    const auto count = qint32(buffer.size() / m_recordLength);
+    const auto position = qint64(m_recordLength) * m_recordsCount + m_headerLength;
+    if (!m_tableFile.seek(position)) {
+        m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    invalidateReadAhead();
+
+    buffer.append(char(END_OF_FILE_MARK));
+    if (m_tableFile.write(buffer) != buffer.size()) {
+        buffer.resize(0);
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    if (m_liveRecordsValid) {
+        m_liveRecords.resize(m_recordsCount + count);
+        for (auto i = 0; i < count; ++i) {
+            if (buffer.constData()[i * m_recordLength] != char(FIELD_DELETED)) {
+                m_liveRecords.setBit(m_recordsCount + i);
+                ++m_liveRecordsCount;
+            }
+        }
+    }
+
+    buffer.resize(0);
+    m_recordsCount += count;
+    m_recordsCountDirty = true;
+    markWritten(count);
+    return true;
+}
+
+
+bool QDbfTablePrivate::appendRecord(const QDbfRecord &record, QByteArray &buffer)
+{
+    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    if (!encodeRecord(record, buffer)) {
+        return false;
+    }
+
+    if (buffer.size() >= DEFAULT_APPEND_BUFFER_SIZE) {
+        return writeRecords(buffer);
+    }
+
+    return true;
+}
+
+
+// Writes what is left in the buffer, then the records count, last update date and memo header
+bool QDbfTablePrivate::flushRecords(QByteArray &buffer)
+{
+    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
+        m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    if (!writeRecords(buffer) || !writeMemoHeader() || !writeRecordsCount()) {
+        return false;
+    }
+
+    setLastUpdate();
+
+    if (!syncIfDue()) {
+        return false;
+    }
+
+    m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+bool QDbfTablePrivate::writeRecordsCount()
+{
+    if (!m_recordsCountDirty) {
+        return true;
+    }
+
+    uchar data[sizeof(qint32)];
+    qToLittleEndian<qint32>(m_recordsCount, data);
+    if (!writeTable(TABLE_RECORDS_COUNT_OFFSET, reinterpret_cast<const char *>(data), sizeof(data))) {
+        return false;
+    }
+
+    m_recordsCountDirty = false;
+    return true;
+}
+
+
+void QDbfTablePrivate::setLastUpdate()
+{
+    const auto &date = QDate::currentDate();
+    if (date == m_lastUpdate) {
+        return;
+    }
+
+    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
+        return;
+    }
+
+    const char data[] = {
+        char(date.year() - (date.year() >= 2000 ? 2000 : 1900)),
+        char(date.month()),
+        char(date.day())
+    };
+
+    // A failed date update is not reported, the edit itself succeeded
+    const auto error = m_error;
+    if (!writeTable(TABLE_LAST_UPDATE_OFFSET, data, sizeof(data))) {
+        m_error = error;
+        return;
+    }
+
+    m_lastUpdate = date;
+}
+
+
+void QDbfTablePrivate::setProjection(const QVector<int> &fieldIndexes)
+{
+    QDbfRecord record;
+    for (auto i = 0; i < fieldIndexes.size(); ++i) {
+        record.append(m_tableRecord.field(fieldIndexes.at(i)));
+    }
+
+    m_record = record;
+    m_currentRecord = m_record;
+    m_bufered = false;
+    updateLayout();
+}
+
+
+void QDbfTablePrivate::appendColumnValue(QDbfColumn &column, int row, const char *recordData) const
+{
+    const auto &field = m_layout.at(column.fieldIndex);
+    const auto data = recordData + field.offset;
+
+    switch (field.type) {
+    case QDbfField::Character:
+        if (field.interned) {
+            qint32 code;
+            internedString(field, data, &code);
+            column.codes.append(code);
+            break;
+        }
+        column.stringData.append(m_codec.toUnicode(data, field.length));
+        column.stringOffsets.append(column.stringData.size());
         break;
     case QDbfField::Memo: {
-        const auto &val = m_textCodec->fromUnicode(value.toString());
-        if (val.isEmpty()) {
-            data = QString().rightJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
+        auto ok = false;
+        const auto index = memoBlockIndex(QByteArray::fromRawData(data, field.length), &ok);
+        if (m_memoType == QDbfTablePrivate::NoMemo || !ok || index < 0) {
+            column.nulls.setBit(row, m_memoType == QDbfTablePrivate::NoMemo || !ok);
         } else {
-            switch (m_memoType) {
-            case Internal::QDbfTablePrivate::DBaseIVMemo:
-            case Internal::QDbfTablePrivate::FoxProMemo: {
-                QDataStream stream(&memoData, QIODevice::WriteOnly);
-                stream.setByteOrder(memoByteOrder());
-                auto signature = quint32(MEMO_SIGNATURE_TEXT);
-                stream << signature;
-                auto valLength = qint32(val.length());
-                stream << valLength;
-            }
-            case Internal::QDbfTablePrivate::DBaseMemo:
-                memoData.append(val);
-                break;
-            default:
-                m_error = QDbfTable::UnsupportedFile;
-                return false;
-            }
-
-            if (10 == m_record.field(fieldIndex).length()) {
-                data = QString::number(m_memoNextFreeBlockIndex)
-                       .rightJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
-            } else if (4 == m_record.field(fieldIndex).length()) {
-                QDataStream stream(&data, QIODevice::WriteOnly);
-                stream.setByteOrder(QDataStream::LittleEndian);
-                stream << m_memoNextFreeBlockIndex;
-            } else {
-                m_error = QDbfTable::UnsupportedFile;
-                return false;
-            }
-
-            memoBlockCount = memoData.length() / m_memoBlockLength + (0 < (memoData.length() % m_memoBlockLength) ? 1 : 0);
+            column.stringData.append(memoFieldValue(index).toString());
         }
+        column.stringOffsets.append(column.stringData.size());
         break;
     }
-    case QDbfField::Integer: {
-        QDataStream stream(&data, QIODevice::WriteOnly);
-        stream.setByteOrder(QDataStream::LittleEndian);
-        auto val = qint32(value.toInt());
-        stream << val;
+    case QDbfField::Integer:
+        column.int32Values.append(int32FromData(data));
+        break;
+    case QDbfField::Logical: {
+        const auto value = quint8(data[0] & ~0x20);
+        if (LOGICAL_TRUE == value || LOGICAL_YES == value) {
+            column.int32Values.append(1);
+        } else {
+            column.int32Values.append(0);
+            column.nulls.setBit(row, LOGICAL_FALSE != value && LOGICAL_NO != value);
+        }
+        break;
+    }
+    case QDbfField::FloatingPoint:
+    case QDbfField::Number: {
+        auto ok = false;
+        const auto value = isBlank(data, field.length) ? 0.0 : numberFromData(data, field.length, &ok);
+        column.doubleValues.append(value);
+        column.nulls.setBit(row, !ok);
+        break;
+    }
+    case QDbfField::Currency:
+        column.doubleValues.append(double(int64FromData(data)) / field.scale);
+        break;
+    case QDbfField::Date: {
+        const auto &date = (DateDecoder == field.decoder) ? dateFromData(data) : QDate();
+        column.julianDays.append(date.isValid() ? qint32(date.toJulianDay()) : 0);
+        column.nulls.setBit(row, !date.isValid());
         break;
     }
     case QDbfField::DateTime: {
-        const auto &val = value.toDateTime();
-        if (!val.isValid()) {
-            m_error = QDbfTable::InvalidValue;
-            return false;
-        }
-
-        if (DATETIME_LENGTH == m_record.field(fieldIndex).length()) {
-            data = val.toString(QLatin1String("yyyyMMddHHmmss"))
-                   .leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
-        } else if (m_record.field(fieldIndex).length() == TIMESTAMP_LENGTH) {
-            const auto julianDay = val.date().toJulianDay();
-            if (std::numeric_limits<qint32>::max() < julianDay) {
-                m_error = QDbfTable::InvalidValue;
-                return false;
-            }
-            const auto day = qint32(julianDay);
-#if QT_VERSION < 0x050200
-            auto msecs = QTime(0, 0, 0, 0).msecsTo(val.time());
-#else
-            auto msecs = val.time().msecsSinceStartOfDay();
-#endif
-            QDataStream stream(&data, QIODevice::WriteOnly);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            stream << day;
-            stream << msecs;
-        } else {
-            m_error = QDbfTable::UnsupportedFile;
-            return false;
+        auto ok = false;
+        qint32 julianDay = 0;
+        qint32 msecs = 0;
+        if (DateTimeDecoder == field.decoder) {
+            const auto &date = dateFromData(data + DATETIME_DATE_OFFSET);
+            msecs = millisecondsFromData(data + DATETIME_TIME_OFFSET, &ok);
+            ok = ok && date.isValid();
+            julianDay = ok ? qint32(date.toJulianDay()) : 0;
+        } else if (TimestampDecoder == field.decoder) {
+            julianDay = int32FromData(data);
+            msecs = int32FromData(data + sizeof(qint32));
+            ok = (0 != julianDay);
         }
+        column.julianDays.append(ok ? julianDay : 0);
+        column.milliseconds.append(ok ? msecs : 0);
+        column.nulls.setBit(row, !ok);
         break;
     }
     default:
-        data = QString().leftJustified(m_record.field(fieldIndex).length(), QLatin1Char(FIELD_SPACER), true).toLatin1();
+        column.nulls.setBit(row);
         break;
     }
+}
 
-    if (0 < memoBlockCount) {
-        Q_ASSERT(0 < memoData.length() && memoData.length() <= memoBlockCount * m_memoBlockLength);
 
-        if (!m_memoFile.isOpen() || !m_memoFile.isWritable()) {
-            m_error = QDbfTable::FileWriteError;
-            return false;
+QDbfRecordView QDbfTablePrivate::recordView(const char *data, const QDbfRecordLayout &layout, int index)
+{
+    return QDbfRecordView(data, layout.constData(), layout.size(), index);
+}
+
+
+static QDbfDecoder fieldDecoder(QDbfField::QDbfType type, int length, int precision)
+{
+    switch (type) {
+    case QDbfField::Character:
+        return CharacterDecoder;
+    case QDbfField::Currency:
+        return CurrencyDecoder;
+    case QDbfField::Date:
+        return (DATE_LENGTH == length) ? DateDecoder : InvalidDecoder;
+    case QDbfField::FloatingPoint:
+    case QDbfField::Number:
+        return (0 == precision) ? IntegralNumberDecoder : DecimalNumberDecoder;
+    case QDbfField::Logical:
+        return LogicalDecoder;
+    case QDbfField::Memo:
+        return MemoDecoder;
+    case QDbfField::Integer:
+        return IntegerDecoder;
+    case QDbfField::DateTime:
+        if (DATETIME_LENGTH == length) {
+            return DateTimeDecoder;
         }
+        return (TIMESTAMP_LENGTH == length) ? TimestampDecoder : InvalidDecoder;
+    default:
+        return InvalidDecoder;
+    }
+}
 
-        auto position = qint64(m_memoBlockLength) * m_memoNextFreeBlockIndex;
-        if (!m_memoFile.seek(position)) {
-            m_error = QDbfTable::FileReadError;
-            return false;
+
+// Compiles the header into the flat plan every decode path runs, once per open() or projection change
+void QDbfTablePrivate::updateLayout()
+{
+    m_layout.resize(m_record.count());
+    for (auto i = 0; i < m_record.count(); ++i) {
+        const auto &field = m_record.field(i);
+        auto &fieldLayout = m_layout[i];
+        fieldLayout.type = field.type();
+        fieldLayout.decoder = fieldDecoder(field.type(), field.length(), field.precision());
+        fieldLayout.offset = field.offset();
+        fieldLayout.length = field.length();
+        fieldLayout.precision = field.precision();
+        fieldLayout.scale = std::pow(CURRENCY_BASE, field.precision());
+        fieldLayout.interned = m_dictionaries.contains(field.offset());
+    }
+
+    // A projection may repeat fields, so every table field is looked up by its offset
+    QSet<int> offsets;
+    for (auto i = 0; i < m_layout.size(); ++i) {
+        offsets.insert(m_layout.at(i).offset);
+    }
+
+    m_layoutCoversTable = true;
+    for (auto i = 0; i < m_tableRecord.count(); ++i) {
+        if (!offsets.contains(m_tableRecord.field(i).offset())) {
+            m_layoutCoversTable = false;
+            break;
         }
+    }
 
-        if (m_memoFile.write(memoData) != memoData.length()) {
-            m_error = QDbfTable::FileWriteError;
+    m_filterSource.clear();
+    m_filter.clear();
+}
+
+
+static bool isNumericType(QDbfField::QDbfType type)
+{
+    switch (type) {
+    case QDbfField::Currency:
+    case QDbfField::FloatingPoint:
+    case QDbfField::Number:
+    case QDbfField::Integer:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+static double numericValue(const QDbfFieldLayout &field, const char *data, bool *ok)
+{
+    switch (field.type) {
+    case QDbfField::Currency:
+        *ok = true;
+        return double(int64FromData(data)) / field.scale;
+    case QDbfField::Integer:
+        *ok = true;
+        return int32FromData(data);
+    default:
+        return numberFromData(data, field.length, ok);
+    }
+}
+
+
+static char logicalFromData(char value)
+{
+    switch (value) {
+    case LOGICAL_TRUE:
+    case LOGICAL_YES:
+    case 't':
+    case 'y':
+        return LOGICAL_TRUE;
+    case LOGICAL_FALSE:
+    case LOGICAL_NO:
+    case 'f':
+    case 'n':
+        return LOGICAL_FALSE;
+    default:
+        return LOGICAL_UNDEFINED;
+    }
+}
+
+
+bool QDbfTablePrivate::compileFilter(const QDbfFilter &filter)
+{
+    QVector<QDbfPredicate> predicates(filter.count());
+    for (auto i = 0; i < filter.count(); ++i) {
+        if (!compilePredicate(filter.condition(i), predicates[i])) {
             return false;
         }
+    }
 
-        QDataStream stream(&m_memoFile);
-        stream.setByteOrder(memoByteOrder());
-        if (!stream.device()->seek(0)) {
-            m_error = QDbfTable::FileReadError;
+    m_filterSource = filter;
+    m_filter = predicates;
+    m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+bool QDbfTablePrivate::compilePredicate(const QDbfFilter::Condition &condition, QDbfPredicate &predicate) const
+{
+    if (condition.fieldIndex < 0 || condition.fieldIndex >= m_layout.size()) {
+        m_error = QDbfTable::InvalidIndexError;
+        return false;
+    }
+
+    predicate.op = condition.op;
+    predicate.field = m_layout.at(condition.fieldIndex);
+
+    const auto &field = predicate.field;
+    const auto &values = condition.values;
+
+    if (QDbfFilter::Range == condition.op && 2 != values.size()) {
+        m_error = QDbfTable::InvalidValue;
+        return false;
+    }
+
+    if (isNumericType(field.type)) {
+        if (QDbfFilter::Prefix == condition.op) {
+            m_error = QDbfTable::InvalidTypeError;
             return false;
         }
-        m_memoNextFreeBlockIndex += memoBlockCount;
-        stream << m_memoNextFreeBlockIndex;
+
+        for (auto i = 0; i < values.size(); ++i) {
+            const auto &value = values.at(i);
+            if (QDbfFilter::Range == condition.op && !value.isValid()) {
+                predicate.numbers.append(0 == i ? -std::numeric_limits<double>::infinity()
+                                                : std::numeric_limits<double>::infinity());
+                continue;
+            }
+
+            auto ok = false;
+            const auto number = value.toDouble(&ok);
+            if (!ok) {
+                m_error = QDbfTable::InvalidValue;
+                return false;
+            }
+            predicate.numbers.append(number);
+        }
+
+        return true;
     }
 
-    auto position = qint64(m_recordLength) * m_currentIndex +
-                    m_headerLength + m_record.field(fieldIndex).offset();
+    switch (field.type) {
+    case QDbfField::Character:
+    case QDbfField::Date:
+        break;
+    case QDbfField::Logical:
+        if (QDbfFilter::Equals != condition.op && QDbfFilter::In != condition.op) {
+            m_error = QDbfTable::InvalidTypeError;
+            return false;
+        }
 
-    if (!m_tableFile.seek(position)) {
-        m_error = QDbfTable::FileReadError;
+        for (auto i = 0; i < values.size(); ++i) {
+            predicate.bytes.append(QByteArray(1, values.at(i).toBool() ? LOGICAL_TRUE : LOGICAL_FALSE));
+        }
+        return true;
+    default:
+        m_error = QDbfTable::InvalidTypeError;
         return false;
     }
 
-    if (m_tableFile.write(data) != data.length()) {
-        m_error = QDbfTable::FileWriteError;
+    if (QDbfField::Date == field.type && QDbfFilter::Prefix == condition.op) {
+        m_error = QDbfTable::InvalidTypeError;
         return false;
     }
 
-    m_currentRecord.setValue(fieldIndex, value);
-    m_error = QDbfTable::NoError;
+    for (auto i = 0; i < values.size(); ++i) {
+        const auto &value = values.at(i);
+        if (QDbfFilter::Range == condition.op && !value.isValid()) {
+            // An empty bound leaves that side of the range open
+            predicate.bytes.append(QByteArray());
+            continue;
+        }
+
+        const auto &bytes = comparandBytes(field, value);
+        if (bytes.isNull()) {
+            m_error = QDbfTable::InvalidValue;
+            return false;
+        }
+
+        if (QDbfFilter::Prefix == condition.op) {
+            if (bytes.size() > field.length) {
+                m_error = QDbfTable::InvalidValue;
+                return false;
+            }
+            predicate.bytes.append(bytes);
+        } else if (QDbfFilter::Range == condition.op) {
+            // A stored value equal to the prefix of a longer minimum is below it, unless
+            // the part cut off sorts no higher than the spaces the value is padded with
+            if (0 == i && bytes.size() > field.length) {
+                auto j = field.length;
+                while (j < bytes.size() && ' ' == bytes.at(j)) {
+                    ++j;
+                }
+                predicate.exclusiveMinimum = j < bytes.size() && quint8(' ') < quint8(bytes.at(j));
+            }
+            predicate.bytes.append(bytes.leftJustified(field.length, ' ', true));
+        } else if (bytes.size() <= field.length) {
+            // A value longer than the field can never be equal to it
+            predicate.bytes.append(bytes.leftJustified(field.length, ' '));
+        }
+    }
+
     return true;
 }
 
 
-void QDbfTablePrivate::setLastUpdate()
+QByteArray QDbfTablePrivate::comparandBytes(const QDbfFieldLayout &field, const QVariant &value) const
 {
-    const auto &date = QDate::currentDate();
-    if (date == m_lastUpdate) {
-        return;
+    if (QDbfField::Date == field.type) {
+        const auto &date = value.toDate();
+        if (!date.isValid()) {
+            return {};
+        }
+        return date.toString(QLatin1String("yyyyMMdd")).toLatin1();
     }
 
-    if (!m_tableFile.isOpen() || !m_tableFile.isWritable()) {
-        return;
-    }
+    const auto &bytes = m_codec.fromUnicode(value.toString());
+    return bytes.isNull() ? QByteArray("") : bytes;
+}
 
-    QDataStream stream(&m_tableFile);
-    stream.setByteOrder(QDataStream::LittleEndian);
-    if (!stream.device()->seek(TABLE_LAST_UPDATE_OFFSET)) {
-        return;
-    }
 
-    auto year = quint8(date.year() - (date.year() >= 2000 ? 2000 : 1900));
-    stream << year;
+bool QDbfTablePrivate::matches(const char *data) const
+{
+    for (auto i = 0; i < m_filter.size(); ++i) {
+        const auto &predicate = m_filter.at(i);
+        const auto &field = predicate.field;
+        const auto fieldData = data + field.offset;
+
+        if (isNumericType(field.type)) {
+            auto ok = false;
+            const auto number = numericValue(field, fieldData, &ok);
+            if (!ok) {
+                return false;
+            }
+
+            if (QDbfFilter::Range == predicate.op) {
+                if (number < predicate.numbers.at(0) || number > predicate.numbers.at(1)) {
+                    return false;
+                }
+            } else if (!predicate.numbers.contains(number)) {
+                return false;
+            }
+            continue;
+        }
 
-    auto month = quint8(date.month());
-    stream << month;
+        if (QDbfField::Logical == field.type) {
+            const auto value = logicalFromData(*fieldData);
+            auto found = false;
+            for (auto j = 0; j < predicate.bytes.size() && !found; ++j) {
+                found = value == predicate.bytes.at(j).at(0);
+            }
+            if (!found) {
+                return false;
+            }
+            continue;
+        }
 
-    auto day = quint8(date.day());
-    stream << day;
+        if (QDbfField::Date == field.type && isBlank(fieldData, field.length)) {
+            return false;
+        }
 
-    m_lastUpdate = date;
+        switch (predicate.op) {
+        case QDbfFilter::Prefix: {
+            const auto &prefix = predicate.bytes.at(0);
+            if (0 != std::memcmp(fieldData, prefix.constData(), size_t(prefix.size()))) {
+                return false;
+            }
+            break;
+        }
+        case QDbfFilter::Range: {
+            const auto &minimum = predicate.bytes.at(0);
+            const auto &maximum = predicate.bytes.at(1);
+            if (!minimum.isEmpty()) {
+                const auto result = std::memcmp(fieldData, minimum.constData(), size_t(field.length));
+                if (result < 0 || (0 == result && predicate.exclusiveMinimum)) {
+                    return false;
+                }
+            }
+            if (!maximum.isEmpty() && std::memcmp(fieldData, maximum.constData(), size_t(field.length)) > 0) {
+                return false;
+            }
+            break;
+        }
+        default: {
+            auto found = false;
+            for (auto j = 0; j < predicate.bytes.size() && !found; ++j) {
+                found = 0 == std::memcmp(fieldData, predicate.bytes.at(j).constData(), size_t(field.length));
+            }
+            if (!found) {
+                return false;
+            }
+            break;
+        }
+        }
+    }
+
+    return true;
 }
 
 } // namespace Internal
@@ -699,6 +2392,9 @@ QDbfTable &QDbfTable::operator=(QDbfTable &&other) Q_DECL_NOEXCEPT
 
 QDbfTable::~QDbfTable()
 {
+    if (nullptr != d) {
+        d->finishWrites();
+    }
     delete d;
     d = nullptr;
 }
@@ -731,6 +2427,7 @@ bool QDbfTable::open(QString fileName, OpenMode openMode)
 
 void QDbfTable::close()
 {
+    d->finishWrites();
     d->clear();
     d->m_tableFile.close();
     d->m_memoFile.close();
@@ -751,14 +2448,28 @@ bool QDbfTable::open(OpenMode openMode)
         return false;
     }
 
-    QDataStream stream(&d->m_tableFile);
-    stream.setByteOrder(QDataStream::LittleEndian);
+    // The whole header is read at once and parsed from memory
+    auto header = d->m_tableFile.read(HEADER_READ_LENGTH);
+    if (header.size() < TABLE_DESCRIPTOR_LENGTH) {
+        d->m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    const auto headerData = reinterpret_cast<const uchar *>(header.constData());
+    d->m_headerLength = qFromLittleEndian<quint16>(headerData + TABLE_FIRST_RECORD_POSITION_OFFSET);
+    if (d->m_headerLength > header.size()) {
+        header.append(d->m_tableFile.read(d->m_headerLength - header.size()));
+        if (d->m_headerLength > header.size()) {
+            d->m_error = QDbfTable::FileReadError;
+            return false;
+        }
+    }
 
+    const auto data = header.constData();
     auto memoType = Internal::QDbfTablePrivate::NoMemo;
 
     // Table version
-    quint8 version;
-    stream >> version;
+    const auto version = quint8(data[0]);
     switch(version) {
     case 0x02:
     case 0x03:
@@ -785,48 +2496,18 @@ bool QDbfTable::open(OpenMode openMode)
     }
 
     // Last update
-    quint8 y;
-    stream >> y;
-    quint8 month;
-    stream >> month;
-    quint8 day;
-    stream >> day;
-
-    auto year = (y < 80 ? 2000 : 1900) + y;
-    d->m_lastUpdate = QDate::fromString(QString(QLatin1String("%1%2%3")).arg(year).arg(month).arg(day), QLatin1String("yyyyMd"));
+    const auto y = quint8(data[TABLE_LAST_UPDATE_OFFSET]);
+    const auto year = (y < 80 ? 2000 : 1900) + y;
+    d->m_lastUpdate = QDate(year, quint8(data[TABLE_LAST_UPDATE_OFFSET + 1]), quint8(data[TABLE_LAST_UPDATE_OFFSET + 2]));
 
     // Number of records
-    if (!d->m_tableFile.seek(TABLE_RECORDS_COUNT_OFFSET)) {
-        d->m_error = QDbfTable::FileReadError;
-        return false;
-    }
-
-    quint32 recordsCount;
-    stream >> recordsCount;
-    d->m_recordsCount = qint32(recordsCount);
+    d->m_recordsCount = qint32(qFromLittleEndian<quint32>(headerData + TABLE_RECORDS_COUNT_OFFSET));
 
-    // Length of header structure
-    if (!d->m_tableFile.seek(TABLE_FIRST_RECORD_POSITION_OFFSET)) {
-        d->m_error = QDbfTable::FileReadError;
-        return false;
-    }
-    stream >> d->m_headerLength;
-
-    // Length of each record
-    if (!d->m_tableFile.seek(RECORD_LENGTH_OFFSET)) {
-        d->m_error = QDbfTable::FileReadError;
-        return false;
-    }
-    stream >> d->m_recordLength;
+    // Length of each record
+    d->m_recordLength = qFromLittleEndian<quint16>(headerData + RECORD_LENGTH_OFFSET);
 
     // Codepage
-    if (!d->m_tableFile.seek(CODEPAGE_OFFSET)) {
-        d->m_error = QDbfTable::FileReadError;
-        return false;
-    }
-
-    quint8 codepage;
-    stream >> codepage;
+    const auto codepage = quint8(data[CODEPAGE_OFFSET]);
     switch(codepage) {
     case CODEPAGE_NOT_SET:
         d->m_codepage = d->m_defaultCodepage;
@@ -860,34 +2541,33 @@ bool QDbfTable::open(OpenMode openMode)
     d->setTextCodec();
 
 
-    auto fieldDescriptorsLength = quint16(d->m_headerLength - TABLE_DESCRIPTOR_LENGTH - TERMINATOR_LENGTH);
+    auto fieldDescriptorsLength = int(d->m_headerLength) - TABLE_DESCRIPTOR_LENGTH - TERMINATOR_LENGTH;
     if (d->m_dbc) {
         fieldDescriptorsLength -= DBC_LENGTH;
     }
 
-    d->m_fieldsCount = fieldDescriptorsLength / FIELD_DESCRIPTOR_LENGTH;
+    if (fieldDescriptorsLength < 0) {
+        d->m_error = QDbfTable::FileReadError;
+        return false;
+    }
+
+    d->m_fieldsCount = quint16(fieldDescriptorsLength / FIELD_DESCRIPTOR_LENGTH);
 
     auto fieldOffset = 1;
     for (auto i = 0; i < d->m_fieldsCount; ++i) {
-        auto fieldDescriptorOffset = qint32(FIELD_DESCRIPTOR_LENGTH) * i + TABLE_DESCRIPTOR_LENGTH;
+        const auto descriptor = data + FIELD_DESCRIPTOR_LENGTH * i + TABLE_DESCRIPTOR_LENGTH;
 
         // Field name
-        if (!d->m_tableFile.seek(fieldDescriptorOffset)) {
-            d->m_error = QDbfTable::FileReadError;
-            return false;
-        }
-        QByteArray fieldName;
+        char fieldName[FIELD_NAME_LENGTH + 1];
+        auto fieldNameLength = 0;
         for (auto j = 0; j <= FIELD_NAME_LENGTH; ++j) {
-            qint8 fieldNameChar;
-            stream >> fieldNameChar;
-            if (FIELD_NAME_SPACER != fieldNameChar) {
-                fieldName.append(fieldNameChar);
+            if (FIELD_NAME_SPACER != descriptor[j]) {
+                fieldName[fieldNameLength++] = descriptor[j];
             }
         }
 
         // Field type
-        quint8 fieldTypeChar;
-        stream >> fieldTypeChar;
+        const auto fieldTypeChar = quint8(descriptor[FIELD_NAME_LENGTH + 1]);
         QDbfField::QDbfType fieldType;
         QVariant defaultValue;
         switch (fieldTypeChar) {
@@ -934,38 +2614,33 @@ bool QDbfTable::open(OpenMode openMode)
             break;
         }
 
-        // Field length
-        if (!d->m_tableFile.seek(fieldDescriptorOffset + FIELD_LENGTH_OFFSET)) {
-            d->m_error = QDbfTable::FileReadError;
-            return false;
-        }
-        quint8 fieldLength;
-        stream >> fieldLength;
-
-        // Decimal count
-        quint8 fieldPrecision;
-        stream >> fieldPrecision;
+        // Field length and decimal count
+        const auto fieldLength = quint8(descriptor[FIELD_LENGTH_OFFSET]);
+        const auto fieldPrecision = quint8(descriptor[FIELD_LENGTH_OFFSET + 1]);
 
         // Build field
-        QDbfField field(d->m_textCodec->toUnicode(fieldName));
+        QDbfField field(d->m_codec.toUnicode(fieldName, fieldNameLength));
         field.setType(fieldType);
         field.setLength(fieldLength);
         field.setPrecision(fieldPrecision);
         field.setOffset(fieldOffset);
         field.setDefaultValue(defaultValue);
         field.setValue(defaultValue);
-        d->m_record.append(field);
+        d->m_tableRecord.append(field);
 
         fieldOffset += fieldLength;
     }
 
+    d->m_record = d->m_tableRecord;
     d->m_currentRecord = d->m_record;
     d->m_currentIndex = Internal::QDbfTablePrivate::BeforeFirstRow;
+    d->updateLayout();
 
-    if (Internal::QDbfTablePrivate::NoMemo != d->m_memoType) {
-        return d->openMemoFile();
+    if (Internal::QDbfTablePrivate::NoMemo != d->m_memoType && !d->openMemoFile()) {
+        return false;
     }
 
+    d->mapFiles();
     return true;
 }
 
@@ -994,6 +2669,26 @@ bool QDbfTable::isOpen() const
 }
 
 
+bool QDbfTable::isMapped() const
+{
+    return nullptr != d->m_tableMap;
+}
+
+
+void QDbfTable::setReadAheadSize(int size)
+{
+    d->m_readAheadSize = qMax(0, size);
+    d->invalidateReadAhead();
+    d->m_readAheadBuffer.clear();
+}
+
+
+int QDbfTable::readAheadSize() const
+{
+    return d->m_readAheadSize;
+}
+
+
 int QDbfTable::size() const
 {
     return d->m_recordsCount;
@@ -1020,232 +2715,627 @@ bool QDbfTable::previous() const
 }
 
 
-bool QDbfTable::next() const
+bool QDbfTable::next() const
+{
+    if (at() < Internal::QDbfTablePrivate::FirstRow) {
+        return first();
+    }
+
+    if (at() >= (d->m_recordsCount - 1)) {
+        return false;
+    }
+
+    return seek(at() + 1);
+}
+
+
+bool QDbfTable::first() const
+{
+    return seek(Internal::QDbfTablePrivate::FirstRow);
+}
+
+
+bool QDbfTable::last() const
+{
+    return seek(d->m_recordsCount - 1);
+}
+
+
+bool QDbfTable::seek(int index) const
+{
+    auto previousIndex = d->m_currentIndex;
+
+    if (index < Internal::QDbfTablePrivate::FirstRow) {
+        d->m_currentIndex = Internal::QDbfTablePrivate::BeforeFirstRow;
+    } else if (index > (d->m_recordsCount - 1)) {
+        d->m_currentIndex = d->m_recordsCount - 1;
+    } else {
+        d->m_currentIndex = index;
+    }
+
+    if (previousIndex != d->m_currentIndex) {
+        d->m_bufered = false;
+    }
+
+    return true;
+}
+
+
+QDate QDbfTable::lastUpdate() const
+{
+    return d->m_lastUpdate;
+}
+
+
+bool QDbfTable::setProjection(const QStringList &fieldNames)
+{
+    QVector<int> fieldIndexes;
+    fieldIndexes.reserve(fieldNames.size());
+    for (auto i = 0; i < fieldNames.size(); ++i) {
+        const auto fieldIndex = d->m_tableRecord.indexOf(fieldNames.at(i));
+        if (fieldIndex < 0) {
+            d->m_error = QDbfTable::InvalidIndexError;
+            return false;
+        }
+        fieldIndexes.append(fieldIndex);
+    }
+
+    return setProjection(fieldIndexes);
+}
+
+
+bool QDbfTable::setProjection(const QVector<int> &fieldIndexes)
+{
+    for (auto i = 0; i < fieldIndexes.size(); ++i) {
+        if (!d->m_tableRecord.contains(fieldIndexes.at(i))) {
+            d->m_error = QDbfTable::InvalidIndexError;
+            return false;
+        }
+    }
+
+    d->setProjection(fieldIndexes);
+    d->m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+void QDbfTable::clearProjection()
+{
+    d->m_record = d->m_tableRecord;
+    d->m_currentRecord = d->m_record;
+    d->m_bufered = false;
+    d->updateLayout();
+}
+
+
+bool QDbfTable::setFilter(const QDbfFilter &filter)
+{
+    return d->compileFilter(filter);
+}
+
+
+QDbfFilter QDbfTable::filter() const
+{
+    return d->m_filterSource;
+}
+
+
+void QDbfTable::clearFilter()
+{
+    d->m_filterSource.clear();
+    d->m_filter.clear();
+}
+
+
+bool QDbfTable::nextMatching() const
+{
+    while (next()) {
+        const auto data = d->recordData(d->m_currentIndex);
+        if (nullptr == data) {
+            d->m_error = QDbfTable::FileReadError;
+            return false;
+        }
+
+        if (d->matches(data)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+QBitArray QDbfTable::liveRecords() const
+{
+    if (!d->scanLiveRecords()) {
+        return {};
+    }
+
+    return d->m_liveRecords;
+}
+
+
+int QDbfTable::liveRecordsCount() const
+{
+    if (!d->scanLiveRecords()) {
+        return 0;
+    }
+
+    return d->m_liveRecordsCount;
+}
+
+
+// The bitmap is used once it is built, otherwise the flags are read as the walk goes,
+// so a caller that fetches lazily never pays for a scan of the whole table
+bool QDbfTable::nextLive() const
+{
+    for (auto index = qMax<int>(at() + 1, Internal::QDbfTablePrivate::FirstRow); index < d->m_recordsCount; ++index) {
+        if (d->m_liveRecordsValid) {
+            if (d->m_liveRecords.testBit(index)) {
+                return seek(index);
+            }
+            continue;
+        }
+
+        const auto data = d->recordData(index);
+        if (nullptr == data) {
+            d->m_error = QDbfTable::FileReadError;
+            return false;
+        }
+
+        if (FIELD_DELETED != quint8(data[0])) {
+            return seek(index);
+        }
+    }
+
+    return false;
+}
+
+
+bool QDbfTable::setInterned(int fieldIndex, bool interned)
+{
+    if (fieldIndex < 0 || fieldIndex >= d->m_layout.size()) {
+        d->m_error = QDbfTable::InvalidIndexError;
+        return false;
+    }
+
+    auto &field = d->m_layout[fieldIndex];
+    if (QDbfField::Character != field.type) {
+        d->m_error = QDbfTable::InvalidTypeError;
+        return false;
+    }
+
+    if (interned && !field.interned) {
+        d->m_dictionaries.insert(field.offset, Internal::QDbfDictionary());
+    } else if (!interned) {
+        d->m_dictionaries.remove(field.offset);
+    }
+
+    field.interned = interned;
+    d->m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+bool QDbfTable::isInterned(int fieldIndex) const
+{
+    return fieldIndex >= 0 && fieldIndex < d->m_layout.size() && d->m_layout.at(fieldIndex).interned;
+}
+
+
+QVector<QString> QDbfTable::dictionary(int fieldIndex) const
+{
+    if (!isInterned(fieldIndex)) {
+        return {};
+    }
+
+    return d->m_dictionaries.value(d->m_layout.at(fieldIndex).offset).values;
+}
+
+
+int QDbfTable::dictionaryCode(int fieldIndex) const
+{
+    if (!isInterned(fieldIndex)) {
+        d->m_error = QDbfTable::InvalidIndexError;
+        return -1;
+    }
+
+    if (d->m_currentIndex < Internal::QDbfTablePrivate::FirstRow) {
+        d->m_error = QDbfTable::InvalidIndexError;
+        return -1;
+    }
+
+    const auto data = d->recordData(d->m_currentIndex);
+    if (nullptr == data) {
+        d->m_error = QDbfTable::FileReadError;
+        return -1;
+    }
+
+    qint32 code;
+    d->internedString(d->m_layout.at(fieldIndex), data, &code);
+    d->m_error = QDbfTable::NoError;
+    return code;
+}
+
+
+void QDbfTable::setMemoLoading(QDbfTable::MemoLoading memoLoading)
+{
+    d->m_memoLoading = memoLoading;
+}
+
+
+QDbfTable::MemoLoading QDbfTable::memoLoading() const
+{
+    return d->m_memoLoading;
+}
+
+
+void QDbfTable::setMemoCacheSize(int size)
+{
+    d->m_memoCache.setMaxCost(qMax(0, size));
+}
+
+
+int QDbfTable::memoCacheSize() const
+{
+    return d->m_memoCache.maxCost();
+}
+
+
+void QDbfTable::setDurability(QDbfTable::Durability durability)
+{
+    d->m_durability = durability;
+}
+
+
+QDbfTable::Durability QDbfTable::durability() const
+{
+    return d->m_durability;
+}
+
+
+void QDbfTable::setSyncRecordsInterval(int records)
+{
+    d->m_syncRecordsInterval = qMax(0, records);
+}
+
+
+int QDbfTable::syncRecordsInterval() const
+{
+    return d->m_syncRecordsInterval;
+}
+
+
+void QDbfTable::setSyncTimeInterval(int msecs)
+{
+    d->m_syncTimeInterval = qMax(0, msecs);
+}
+
+
+int QDbfTable::syncTimeInterval() const
+{
+    return d->m_syncTimeInterval;
+}
+
+
+bool QDbfTable::sync()
+{
+    if (!d->m_tableFile.isOpen()) {
+        d->m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    if (!d->sync()) {
+        return false;
+    }
+
+    d->m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+QDbfTable::Statistics QDbfTable::statistics() const
+{
+    return d->m_statistics;
+}
+
+
+void QDbfTable::resetStatistics()
+{
+    d->m_statistics = QDbfTable::Statistics();
+}
+
+
+bool QDbfTable::setRecord(const QDbfRecord &record)
 {
-    if (at() < Internal::QDbfTablePrivate::FirstRow) {
-        return first();
+    if (record.isDeleted() && !removeRecord(d->m_currentIndex)) {
+        return false;
     }
 
-    if (at() >= (d->m_recordsCount - 1)) {
+    if (!d->writeRecord(record)) {
         return false;
     }
 
-    return seek(at() + 1);
+    d->m_currentIndex = record.recordIndex();
+    d->setLastUpdate();
+    d->markWritten(1);
+
+    return d->syncIfDue();
 }
 
 
-bool QDbfTable::first() const
+QDbfRecord QDbfTable::record() const
 {
-    return seek(Internal::QDbfTablePrivate::FirstRow);
-}
+    if (!d->bufferRecord()) {
+        return d->m_currentRecord;
+    }
 
+    // Memos that are not loaded yet are left invalid, so writing the record back keeps them
+    for (auto i = 0; i < d->m_currentRecord.count(); ++i) {
+        if (!d->isDeferredMemo(i)) {
+            d->decodeField(i);
+        } else if (!d->m_decodedFields.testBit(i)) {
+            d->m_currentRecord.setValue(i, QVariant());
+        }
+    }
 
-bool QDbfTable::last() const
-{
-    return seek(d->m_recordsCount - 1);
+    d->m_error = QDbfTable::NoError;
+    return d->m_currentRecord;
 }
 
 
-bool QDbfTable::seek(int index) const
+bool QDbfTable::readRecord(QDbfRecord &record) const
 {
-    auto previousIndex = d->m_currentIndex;
-
-    if (index < Internal::QDbfTablePrivate::FirstRow) {
-        d->m_currentIndex = Internal::QDbfTablePrivate::BeforeFirstRow;
-    } else if (index > (d->m_recordsCount - 1)) {
-        d->m_currentIndex = d->m_recordsCount - 1;
-    } else {
-        d->m_currentIndex = index;
+    if (d->m_currentIndex < Internal::QDbfTablePrivate::FirstRow || !d->m_tableFile.isOpen()) {
+        d->m_error = QDbfTable::InvalidIndexError;
+        return false;
     }
 
-    if (previousIndex != d->m_currentIndex) {
-        d->m_bufered = false;
+    if (!d->readRecord(d->m_currentIndex, record)) {
+        return false;
     }
 
+    d->m_error = QDbfTable::NoError;
     return true;
 }
 
 
-QDate QDbfTable::lastUpdate() const
+bool QDbfTable::readRecords(int first, int count, QVector<QDbfRecord> &records) const
 {
-    return d->m_lastUpdate;
-}
-
+    if (!d->m_tableFile.isOpen()) {
+        d->m_error = QDbfTable::FileReadError;
+        return false;
+    }
 
-bool QDbfTable::setRecord(const QDbfRecord &record)
-{
-    if (record.isDeleted() && !removeRecord(d->m_currentIndex)) {
+    if (first < 0 || count < 0 || first > d->m_recordsCount) {
+        d->m_error = QDbfTable::InvalidIndexError;
         return false;
     }
 
-    for (auto i = 0; i < record.count(); ++i) {
-        const auto &field = record.field(i);
-        if (!d->setValue(i, field.value())) {
+    records.resize(qMin(count, d->m_recordsCount - first));
+    for (auto i = 0; i < records.size(); ++i) {
+        if (!d->readRecord(first + i, records[i])) {
+            records.resize(i);
             return false;
         }
     }
 
-    d->m_currentIndex = record.recordIndex();
-    d->setLastUpdate();
-
+    d->m_error = QDbfTable::NoError;
     return true;
 }
 
 
-QDbfRecord QDbfTable::record() const
+QDbfRecordView QDbfTable::recordView() const
 {
-    if (d->m_bufered) {
-        return d->m_currentRecord;
+    if (d->m_currentIndex < Internal::QDbfTablePrivate::FirstRow || !d->m_tableFile.isOpen()) {
+        return QDbfRecordView();
     }
 
-    d->m_currentRecord = d->m_record;
-
-    if (d->m_currentIndex < Internal::QDbfTablePrivate::FirstRow) {
-        return d->m_currentRecord;
+    const auto data = d->recordData(d->m_currentIndex);
+    if (nullptr == data) {
+        d->m_error = QDbfTable::FileReadError;
+        return QDbfRecordView();
     }
 
+    d->m_error = QDbfTable::NoError;
+    return d->recordView(data, d->m_layout, d->m_currentIndex);
+}
+
+
+bool QDbfTable::readColumns(int first, int count, const QVector<int> &fieldIndexes, QDbfColumnBatch &batch) const
+{
+    batch.clear();
+
     if (!d->m_tableFile.isOpen()) {
         d->m_error = QDbfTable::FileReadError;
-        return d->m_currentRecord;
+        return false;
     }
 
-    auto position = qint64(d->m_recordLength) * d->m_currentIndex + d->m_headerLength;
-
-    if (!d->m_tableFile.seek(position)) {
-        d->m_error = QDbfTable::FileReadError;
-        return d->m_currentRecord;
+    if (first < 0 || count < 0 || first > d->m_recordsCount) {
+        d->m_error = QDbfTable::InvalidIndexError;
+        return false;
     }
 
-    d->m_currentRecord.setRecordIndex(d->m_currentIndex);
+    QVector<int> fields = fieldIndexes;
+    if (fields.isEmpty()) {
+        fields.reserve(d->m_layout.size());
+        for (auto i = 0; i < d->m_layout.size(); ++i) {
+            fields.append(i);
+        }
+    }
 
-    const auto &recordData = d->m_tableFile.read(d->m_recordLength);
-    if (recordData.length() != d->m_recordLength) {
-        d->m_error = QDbfTable::FileReadError;
-        return d->m_record;
+    for (auto i = 0; i < fields.size(); ++i) {
+        if (fields.at(i) < 0 || fields.at(i) >= d->m_layout.size()) {
+            d->m_error = QDbfTable::InvalidIndexError;
+            return false;
+        }
     }
 
-    d->m_currentRecord.setDeleted(FIELD_DELETED == recordData.at(0));
+    batch.first = first;
+    batch.count = qMin(count, d->m_recordsCount - first);
+    batch.deleted.fill(false, batch.count);
+    batch.columns.resize(fields.size());
 
-    for (auto i = 0; i < d->m_currentRecord.count(); ++i) {
-        const auto &byteArray = recordData.mid(d->m_currentRecord.field(i).offset(), d->m_currentRecord.field(i).length());
-        QVariant value;
-        switch (d->m_currentRecord.field(i).type()) {
+    for (auto i = 0; i < fields.size(); ++i) {
+        auto &column = batch.columns[i];
+        column.fieldIndex = fields.at(i);
+        column.type = d->m_layout.at(column.fieldIndex).type;
+        column.nulls.fill(false, batch.count);
+        switch (column.type) {
         case QDbfField::Character:
-            value = d->m_textCodec->toUnicode(byteArray);
+            if (d->m_layout.at(column.fieldIndex).interned) {
+                column.codes.reserve(batch.count);
+                break;
+            }
+            column.stringOffsets.reserve(batch.count + 1);
+            column.stringOffsets.append(0);
             break;
-        case QDbfField::Currency: {
-            QDataStream stream(byteArray);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            qint64 val;
-            stream >> val;
-            value = qreal(val) / std::pow(CURRENCY_BASE, d->m_currentRecord.field(i).precision());
+        case QDbfField::Memo:
+            column.stringOffsets.reserve(batch.count + 1);
+            column.stringOffsets.append(0);
             break;
-        }
-        case QDbfField::Date:
-            value = QVariant(d->dateFromByteArray(byteArray));
+        case QDbfField::Integer:
+        case QDbfField::Logical:
+            column.int32Values.reserve(batch.count);
             break;
         case QDbfField::FloatingPoint:
         case QDbfField::Number:
-            if (0 == d->m_record.field(i).precision()) {
-                value = byteArray.trimmed().toInt();
-            } else {
-                value = QVariant(byteArray.trimmed()).toReal();
-            }
+        case QDbfField::Currency:
+            column.doubleValues.reserve(batch.count);
             break;
-        case QDbfField::Logical: {
-            const auto &val = QString::fromLatin1(byteArray.toUpper());
-            if (val == QString(QLatin1Char(LOGICAL_UNDEFINED))) {
-                value = QVariant::Bool;
-            } else if (val == QString(QLatin1Char(LOGICAL_TRUE)) || val == QString(QLatin1Char(LOGICAL_YES))) {
-                value = true;
-            } else if (val == QString(QLatin1Char(LOGICAL_FALSE)) || val == QString(QLatin1Char(LOGICAL_NO))) {
-                value = false;
-            } else {
-                value = QVariant::Invalid;
-            }
+        case QDbfField::DateTime:
+            column.milliseconds.reserve(batch.count);
+            column.julianDays.reserve(batch.count);
             break;
-        }
-        case QDbfField::Memo:
-            if (d->m_memoType == Internal::QDbfTablePrivate::NoMemo) {
-                value = QVariant::Invalid;
-            } else if (10 == byteArray.length()) {
-                if (!byteArray.trimmed().isEmpty()) {
-                    auto ok = false;
-                    auto index = QString::fromLatin1(byteArray).toInt(&ok);
-                    value = ok ? d->memoFieldValue(index) : QVariant::Invalid;
-                } else {
-                    value = QVariant::String;
-                }
-            } else if (4 == byteArray.length()) {
-                QDataStream stream(byteArray);
-                stream.setByteOrder(QDataStream::LittleEndian);
-                qint32 index;
-                stream >> index;
-                value = d->memoFieldValue(index);
-            } else {
-                value = QVariant::Invalid;
-            }
+        case QDbfField::Date:
+            column.julianDays.reserve(batch.count);
             break;
-        case QDbfField::Integer: {
-            QDataStream stream(byteArray);
-            stream.setByteOrder(QDataStream::LittleEndian);
-            qint32 val;
-            stream >> val;
-            value = val;
+        default:
             break;
         }
-        case QDbfField::DateTime: {
-            if (DATETIME_LENGTH == byteArray.length()) {
-                const auto &date = d->dateFromByteArray(byteArray.mid(DATETIME_DATE_OFFSET, DATE_LENGTH));
-                const auto &time = d->timeFromByteArray(byteArray.mid(DATETIME_TIME_OFFSET, TIME_LENGTH));
-                value = QVariant(QDateTime(date, time));
-            } else if (TIMESTAMP_LENGTH == byteArray.length()) {
-                QDataStream stream(byteArray);
-                stream.setByteOrder(QDataStream::LittleEndian);
-                qint32 day;
-                stream >> day;
-                qint32 msecs;
-                stream >> msecs;
-                const auto &date = QDate::fromJulianDay(day);
-#if QT_VERSION < 0x050200
-                const auto &time = QTime(0, 0, 0, 0).addMSecs(msecs);
-#else
-                const auto &time = QTime::fromMSecsSinceStartOfDay(msecs);
-#endif
-                value = QVariant(QDateTime(date, time));
-            } else {
-                value = QVariant::Invalid;
-            }
-            break;
+    }
+
+    for (auto row = 0; row < batch.count; ++row) {
+        const auto data = d->recordData(first + row);
+        if (nullptr == data) {
+            d->m_error = QDbfTable::FileReadError;
+            return false;
         }
-        default:
-            value = QVariant::Invalid;
+
+        batch.deleted.setBit(row, FIELD_DELETED == quint8(data[0]));
+        for (auto i = 0; i < batch.columns.size(); ++i) {
+            d->appendColumnValue(batch.columns[i], row, data);
+        }
+    }
+
+    for (auto i = 0; i < batch.columns.size(); ++i) {
+        auto &column = batch.columns[i];
+        const auto &field = d->m_layout.at(column.fieldIndex);
+        if (field.interned) {
+            column.dictionary = d->m_dictionaries.value(field.offset).values;
+        }
+    }
+
+    d->m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+QVariant QDbfTable::parallelScan(const ScanFunction &function, const ReduceFunction &reduce, int chunkSize) const
+{
+    if (!d->m_tableFile.isOpen() || 0 == d->m_recordLength) {
+        d->m_error = QDbfTable::FileReadError;
+        return QVariant();
+    }
+
+    if (0 == d->m_recordsCount) {
+        d->m_error = QDbfTable::NoError;
+        return reduce ? QVariant() : QVariant(QVariantList());
+    }
+
+    // Workers read through their own handles, so nothing may be left in the write buffer
+    if (!d->flushPendingRecords()) {
+        return QVariant();
+    }
+
+    if (d->m_tableFile.isWritable() && !d->m_tableFile.flush()) {
+        d->m_error = QDbfTable::FileWriteError;
+        return QVariant();
+    }
+
+    Internal::QDbfScan scan;
+    scan.fileName = d->m_tableFile.fileName();
+    scan.layout = &d->m_layout;
+    scan.function = &function;
+    scan.headerLength = d->m_headerLength;
+    scan.recordLength = d->m_recordLength;
+    scan.recordsCount = d->m_recordsCount;
+    scan.chunkSize = (0 < chunkSize) ? chunkSize : qMax(1, DEFAULT_SCAN_CHUNK_SIZE / d->m_recordLength);
+    scan.chunksCount = int((qint64(scan.recordsCount) + scan.chunkSize - 1) / scan.chunkSize);
+
+    if (nullptr != d->m_tableMap &&
+        scan.recordLength * scan.recordsCount + scan.headerLength <= d->m_tableMapSize) {
+        scan.map = reinterpret_cast<const char *>(d->m_tableMap);
+    }
+
+    QVector<QVariant> results(scan.chunksCount);
+    scan.results = results.data();
+
+    // The calling thread takes part in the scan, so it completes even when the pool is busy
+    auto pool = QThreadPool::globalInstance();
+    const auto workersCount = qMin(scan.chunksCount, qMax(1, pool->maxThreadCount()));
+    QVector<QSharedPointer<Internal::QDbfScanWorker> > workers;
+    auto startedCount = 0;
+    for (auto i = 1; i < workersCount; ++i) {
+        QSharedPointer<Internal::QDbfScanWorker> worker(new Internal::QDbfScanWorker(&scan));
+        if (!pool->tryStart(worker.data())) {
             break;
         }
+        workers.append(worker);
+        ++startedCount;
+    }
 
-        d->m_currentRecord.setValue(i, value);
+    Internal::QDbfScanWorker(&scan).run();
+    scan.finished.acquire(startedCount + 1);
+
+    if (scan.hasFailed()) {
+        d->m_error = QDbfTable::FileReadError;
+        return QVariant();
     }
 
-    d->m_bufered = true;
     d->m_error = QDbfTable::NoError;
-    return d->m_currentRecord;
+    if (!reduce) {
+        return QVariant(results.toList());
+    }
+
+    auto result = results.at(0);
+    for (auto i = 1; i < results.size(); ++i) {
+        result = reduce(result, results.at(i));
+    }
+
+    return result;
 }
 
 
 bool QDbfTable::setValue(int fieldIndex, const QVariant &value)
 {
-    if (d->setValue(fieldIndex, value)) {
-        d->setLastUpdate();
-        return true;
+    if (!d->setValue(fieldIndex, value)) {
+        return false;
     }
 
-    return false;
+    d->setLastUpdate();
+    d->markWritten(1);
+    return d->syncIfDue();
 }
 
 
 QVariant QDbfTable::value(int fieldIndex) const
 {
-    return record().value(fieldIndex);
+    if (d->bufferRecord() && d->m_currentRecord.contains(fieldIndex)) {
+        d->decodeField(fieldIndex);
+    }
+
+    return d->m_currentRecord.value(fieldIndex);
 }
 
 
@@ -1257,13 +3347,54 @@ bool QDbfTable::setValue(const QString &name, const QVariant &value)
 
 QVariant QDbfTable::value(const QString &name) const
 {
-    return record().value(name);
+    return value(d->m_record.indexOf(name));
+}
+
+
+QDbfFieldKey QDbfTable::fieldKey(const QString &name) const
+{
+    return d->m_record.fieldKey(name);
+}
+
+
+bool QDbfTable::setValue(QDbfFieldKey key, const QVariant &value)
+{
+    return setValue(key.index(), value);
+}
+
+
+QVariant QDbfTable::value(QDbfFieldKey key) const
+{
+    return value(key.index());
+}
+
+
+QVariant QDbfTable::memo(int fieldIndex) const
+{
+    if (QDbfField::Memo != d->m_record.field(fieldIndex).type()) {
+        d->m_error = d->m_record.contains(fieldIndex) ? QDbfTable::InvalidTypeError : QDbfTable::InvalidIndexError;
+        return QVariant();
+    }
+
+    return value(fieldIndex);
+}
+
+
+bool QDbfTable::isNull(int fieldIndex) const
+{
+    return value(fieldIndex).isNull();
+}
+
+
+bool QDbfTable::isNull(const QString &name) const
+{
+    return isNull(d->m_record.indexOf(name));
 }
 
 
 bool QDbfTable::addRecord()
 {
-    QDbfRecord newRecord(record());
+    QDbfRecord newRecord(d->m_record);
     newRecord.clearValues();
     newRecord.setDeleted(false);
     newRecord.setRecordIndex(size()+1);
@@ -1273,48 +3404,41 @@ bool QDbfTable::addRecord()
 
 bool QDbfTable::addRecord(const QDbfRecord &record)
 {
-    if (!d->m_tableFile.isOpen() || !d->m_tableFile.isWritable()) {
-        d->m_error = QDbfTable::FileWriteError;
-        return false;
-    }
+    return addRecords(QVector<QDbfRecord>(1, record));
+}
 
-    // Write new records count
-    QDataStream stream(&d->m_tableFile);
-    stream.setByteOrder(QDataStream::LittleEndian);
-    if (!stream.device()->seek(TABLE_RECORDS_COUNT_OFFSET)) {
-        d->m_error = QDbfTable::FileReadError;
-        return false;
-    }
-    stream << ++d->m_recordsCount;
 
-    // Rewind and replace (0x1A) to (0x20) for previous record
-    // Otherwise most DBF readers will treat records with 0x1A as "deleted"
-    const qint64 position_old = static_cast<qint64>(d->m_recordLength) * (d->m_recordsCount-1) + d->m_headerLength;
-    if (!d->m_tableFile.seek(position_old)) {
-        d->m_error = QDbfTable::FileReadError;
-        return false;
-    }
-    if (d->m_tableFile.write(QByteArray(1, FIELD_SPACER)) != 1) {
-        d->m_error = QDbfTable::FileWriteError;
-        return false;
-    }
+// Rows are encoded back to back and the header is updated once for the whole batch
+bool QDbfTable::addRecords(const QVector<QDbfRecord> &records)
+{
+    QByteArray buffer;
+    buffer.reserve(int(qMin<qint64>(qint64(records.size()) * d->m_recordLength, DEFAULT_APPEND_BUFFER_SIZE)) + 1);
 
-    // Write end of file mark
-    auto position = qint64(d->m_recordLength) * d->m_recordsCount + d->m_headerLength;
+    auto result = true;
+    for (auto i = 0; i < records.size(); ++i) {
+        if (!d->appendRecord(records.at(i), buffer)) {
+            result = false;
+            break;
+        }
+    }
 
-    if (!d->m_tableFile.seek(position)) {
-        d->m_error = QDbfTable::FileReadError;
+    // Records encoded before a failure are still written, so the header matches the file
+    const auto error = d->m_error;
+    if (!d->flushRecords(buffer)) {
         return false;
     }
 
-    if (d->m_tableFile.write(QByteArray(1, END_OF_FILE_MARK)) != 1) {
-        d->m_error = QDbfTable::FileWriteError;
+    if (!result) {
+        d->m_error = error;
         return false;
     }
 
-    d->m_currentIndex = d->m_recordsCount - 1;
+    if (!records.isEmpty()) {
+        d->m_currentIndex = d->m_recordsCount - 1;
+        d->m_bufered = false;
+    }
 
-    return setRecord(record);
+    return true;
 }
 
 
@@ -1325,15 +3449,17 @@ bool QDbfTable::removeRecord(int index)
         return false;
     }
 
-    auto position = qint64(d->m_recordLength) * index + d->m_headerLength;
-
-    if (!d->m_tableFile.seek(position)) {
-        d->m_error = QDbfTable::FileReadError;
+    if (index < Internal::QDbfTablePrivate::FirstRow || index >= d->m_recordsCount) {
+        d->m_error = QDbfTable::InvalidIndexError;
         return false;
     }
 
-    if (d->m_tableFile.write(QByteArray(1, FIELD_DELETED)) != 1) {
-        d->m_error = QDbfTable::FileWriteError;
+    d->invalidateReadAhead();
+
+    auto position = qint64(d->m_recordLength) * index + d->m_headerLength;
+
+    const char flag = char(FIELD_DELETED);
+    if (!d->writeTable(position, &flag, RECORD_DELETION_FLAG_LENGTH)) {
         return false;
     }
 
@@ -1341,7 +3467,17 @@ bool QDbfTable::removeRecord(int index)
         d->m_currentRecord.setDeleted(true);
     }
 
+    if (d->m_liveRecordsValid && d->m_liveRecords.testBit(index)) {
+        d->m_liveRecords.clearBit(index);
+        --d->m_liveRecordsCount;
+    }
+
     d->setLastUpdate();
+    d->markWritten(1);
+
+    if (!d->syncIfDue()) {
+        return false;
+    }
 
     d->m_error = QDbfTable::NoError;
     return true;
@@ -1354,6 +3490,37 @@ bool QDbfTable::removeRecord()
 }
 
 
+// Batches nest, the outermost commit() writes everything that was queued
+bool QDbfTable::beginBatch()
+{
+    if (!d->m_tableFile.isOpen() || !d->m_tableFile.isWritable()) {
+        d->m_error = QDbfTable::FileWriteError;
+        return false;
+    }
+
+    ++d->m_batchDepth;
+    d->m_error = QDbfTable::NoError;
+    return true;
+}
+
+
+bool QDbfTable::commit()
+{
+    if (0 == d->m_batchDepth || 0 < --d->m_batchDepth) {
+        d->m_error = QDbfTable::NoError;
+        return true;
+    }
+
+    return d->commitBatch();
+}
+
+
+bool QDbfTable::isBatchActive() const
+{
+    return d->m_batchDepth > 0;
+}
+
+
 void QDbfTable::swap(QDbfTable &other) Q_DECL_NOEXCEPT
 {
     std::swap(d, other.d);
@@ -1365,6 +3532,46 @@ void swap(QDbfTable &lhs, QDbfTable &rhs)
     lhs.swap(rhs);
 }
 
+
+namespace Internal {
+
+bool QDbfTableAppendAccess::appendRecord(QDbfTable &table, const QDbfRecord &record, QByteArray &buffer)
+{
+    return table.d->appendRecord(record, buffer);
+}
+
+
+bool QDbfTableAppendAccess::flushRecords(QDbfTable &table, QByteArray &buffer)
+{
+    return table.d->flushRecords(buffer);
+}
+
+} // namespace Internal
+
+
+QDbfWriteBatch::QDbfWriteBatch(QDbfTable &table) :
+    m_table(table),
+    m_active(table.beginBatch())
+{
+}
+
+
+QDbfWriteBatch::~QDbfWriteBatch()
+{
+    commit();
+}
+
+
+bool QDbfWriteBatch::commit()
+{
+    if (!m_active) {
+        return true;
+    }
+
+    m_active = false;
+    return m_table.commit();
+}
+
 } // namespace QDbf
 
 
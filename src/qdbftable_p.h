@@ -0,0 +1,46 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+
+#ifndef QDBFTABLE_P_H
+#define QDBFTABLE_P_H
+
+#include <QByteArray>
+
+#include "qdbftable.h"
+
+
+namespace QDbf {
+namespace Internal {
+
+// The append path of a table for QDbfAppender, kept out of the public QDbfTable interface
+class QDbfTableAppendAccess final
+{
+public:
+    static bool appendRecord(QDbfTable &table, const QDbfRecord &record, QByteArray &buffer);
+    static bool flushRecords(QDbfTable &table, QByteArray &buffer);
+};
+
+} // namespace Internal
+} // namespace QDbf
+
+#endif // QDBFTABLE_P_H
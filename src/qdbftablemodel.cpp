@@ -158,6 +158,12 @@ QDate QDbfTableModel::lastUpdate() const
 }
 
 
+bool QDbfTableModel::setInterned(int column, bool interned)
+{
+    return d->m_dbfTable->setInterned(column, interned);
+}
+
+
 int QDbfTableModel::rowCount(const QModelIndex &) const
 {
     return d->m_records.count();
@@ -255,15 +261,17 @@ bool QDbfTableModel::insertRows(int row, int count, const QModelIndex &)
         return false;
     }
 
+    QDbfRecord newRecord(d->m_record);
+    newRecord.clearValues();
+    newRecord.setDeleted(false);
+
+    const auto first = d->m_dbfTable->size();
+    const auto result = d->m_dbfTable->addRecords(QVector<QDbfRecord>(count, newRecord));
+
     QVector<QDbfRecord> records;
     records.reserve(count);
-    auto result = true;
-    for (auto i = 0; i < count; ++i) {
-        if (!d->m_dbfTable->addRecord()) {
-            result = false;
-            break;
-        }
-        d->m_dbfTable->last();
+    for (auto i = first; i < d->m_dbfTable->size(); ++i) {
+        d->m_dbfTable->seek(i);
         records.append(d->m_dbfTable->record());
     }
 
@@ -399,17 +407,19 @@ void QDbfTableModel::fetchMore(const QModelIndex &)
     records.reserve(fetchSize);
     auto deletedRecordsCount = 0;
     auto fetchedRecordSize = 0;
-    while (d->m_dbfTable->next()) {
-        const auto &record = d->m_dbfTable->record();
-        if (record.isDeleted()) {
-            ++deletedRecordsCount;
-            continue;
-        }
-        records.append(record);
+    auto index = d->m_dbfTable->at();
+    while (d->m_dbfTable->nextLive()) {
+        deletedRecordsCount += d->m_dbfTable->at() - index - 1;
+        index = d->m_dbfTable->at();
+        records.append(d->m_dbfTable->record());
         if (++fetchedRecordSize == fetchSize) {
             break;
         }
     }
+
+    if (fetchedRecordSize < fetchSize) {
+        deletedRecordsCount += d->m_dbfTable->size() - index - 1;
+    }
     d->m_lastRecordIndex = d->m_dbfTable->at();
 
     beginInsertRows({}, d->m_records.size(), d->m_records.size() + records.size() - 1);
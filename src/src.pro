@@ -39,14 +39,27 @@ contains(QT_CONFIG, reduce_exports):CONFIG += hide_symbols
 HEADERS += \
     $$SOURCE_TREE/include/qdbf_compat.h \
     $$SOURCE_TREE/include/qdbf_global.h \
+    $$SOURCE_TREE/include/qdbfappender.h \
+    $$SOURCE_TREE/include/qdbfcolumn.h \
     $$SOURCE_TREE/include/qdbffield.h \
+    $$SOURCE_TREE/include/qdbffilter.h \
     $$SOURCE_TREE/include/qdbfrecord.h \
+    $$SOURCE_TREE/include/qdbfrecordview.h \
     $$SOURCE_TREE/include/qdbftable.h \
-    $$SOURCE_TREE/include/qdbftablemodel.h
+    $$SOURCE_TREE/include/qdbftablemodel.h \
+    $$SOURCE_TREE/src/qdbfcodec_p.h \
+    $$SOURCE_TREE/src/qdbfdecoder_p.h \
+    $$SOURCE_TREE/src/qdbfsimd_p.h \
+    $$SOURCE_TREE/src/qdbftable_p.h
 
 SOURCES += \
+    $$SOURCE_TREE/src/qdbfappender.cpp \
+    $$SOURCE_TREE/src/qdbfcodec.cpp \
+    $$SOURCE_TREE/src/qdbfcolumn.cpp \
     $$SOURCE_TREE/src/qdbffield.cpp \
+    $$SOURCE_TREE/src/qdbffilter.cpp \
     $$SOURCE_TREE/src/qdbfrecord.cpp \
+    $$SOURCE_TREE/src/qdbfrecordview.cpp \
     $$SOURCE_TREE/src/qdbftable.cpp \
     $$SOURCE_TREE/src/qdbftablemodel.cpp
 
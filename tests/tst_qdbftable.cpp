@@ -0,0 +1,337 @@
+/***************************************************************************
+**
+** Copyright (C) 2020 Ivan Pinezhaninov <ivan.pinezhaninov@gmail.com>
+**
+** This file is part of the QDbf - Qt DBF library.
+**
+** The QDbf is free software: you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** The QDbf is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with the QDbf.  If not, see <http://www.gnu.org/licenses/>.
+**
+***************************************************************************/
+
+
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+#include <QtTest>
+
+#include "qdbffilter.h"
+#include "qdbfrecord.h"
+#include "qdbftable.h"
+
+using namespace QDbf;
+
+
+namespace {
+
+const int TABLE_DESCRIPTOR_LENGTH = 32;
+const int FIELD_DESCRIPTOR_LENGTH = 32;
+const int FIELD_NAME_LENGTH = 10;
+const int DBC_LENGTH = 263;
+const int MEMO_HEADER_LENGTH = 512;
+const int MEMO_BLOCK_LENGTH = 64;
+const quint32 MEMO_SIGNATURE_TEXT = 1;
+
+struct Field
+{
+    QByteArray name;
+    char type;
+    int length;
+    int precision;
+};
+
+
+// Writes a table with the given records, each one holds the bytes of every field
+bool writeTable(const QString &fileName, quint8 version, const QVector<Field> &fields,
+                const QVector<QByteArray> &records)
+{
+    auto recordLength = 1;
+    for (auto i = 0; i < fields.size(); ++i) {
+        recordLength += fields.at(i).length;
+    }
+
+    const auto dbc = (0x30 == version || 0x31 == version);
+    const auto headerLength = TABLE_DESCRIPTOR_LENGTH + fields.size() * FIELD_DESCRIPTOR_LENGTH + 1 +
+                              (dbc ? DBC_LENGTH : 0);
+
+    QByteArray header(headerLength, '\0');
+    auto data = reinterpret_cast<uchar *>(header.data());
+    const auto &today = QDate::currentDate();
+    data[0] = version;
+    data[1] = uchar(today.year() % 100);
+    data[2] = uchar(today.month());
+    data[3] = uchar(today.day());
+    qToLittleEndian<quint32>(quint32(records.size()), data + 4);
+    qToLittleEndian<quint16>(quint16(headerLength), data + 8);
+    qToLittleEndian<quint16>(quint16(recordLength), data + 10);
+    data[29] = 0x03; // Windows-1252
+
+    auto fieldOffset = 1;
+    for (auto i = 0; i < fields.size(); ++i) {
+        const auto &field = fields.at(i);
+        const auto descriptor = data + TABLE_DESCRIPTOR_LENGTH + i * FIELD_DESCRIPTOR_LENGTH;
+        memcpy(descriptor, field.name.constData(), size_t(qMin(field.name.size(), FIELD_NAME_LENGTH)));
+        descriptor[11] = uchar(field.type);
+        qToLittleEndian<quint32>(quint32(fieldOffset), descriptor + 12);
+        descriptor[16] = uchar(field.length);
+        descriptor[17] = uchar(field.precision);
+        fieldOffset += field.length;
+    }
+    data[TABLE_DESCRIPTOR_LENGTH + fields.size() * FIELD_DESCRIPTOR_LENGTH] = 0x0D;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(header) != header.size()) {
+        return false;
+    }
+
+    for (auto i = 0; i < records.size(); ++i) {
+        const auto &record = QByteArray(1, ' ') + records.at(i).leftJustified(recordLength - 1, ' ', true);
+        if (file.write(record) != record.size()) {
+            return false;
+        }
+    }
+
+    return file.putChar(0x1A);
+}
+
+
+// Writes a FoxPro memo file holding the given memos one after another,
+// the block index of every memo is appended to indexes
+bool writeFoxProMemo(const QString &fileName, const QVector<QByteArray> &memos, QVector<qint32> &indexes)
+{
+    QByteArray data(MEMO_HEADER_LENGTH, '\0');
+    for (auto i = 0; i < memos.size(); ++i) {
+        indexes.append(data.size() / MEMO_BLOCK_LENGTH);
+
+        QByteArray header(8, '\0');
+        qToBigEndian<quint32>(MEMO_SIGNATURE_TEXT, reinterpret_cast<uchar *>(header.data()));
+        qToBigEndian<quint32>(quint32(memos.at(i).size()), reinterpret_cast<uchar *>(header.data()) + 4);
+
+        const auto &memo = header + memos.at(i);
+        const auto blocksLength = (memo.size() + MEMO_BLOCK_LENGTH - 1) / MEMO_BLOCK_LENGTH * MEMO_BLOCK_LENGTH;
+        data += memo.leftJustified(blocksLength, '\0');
+    }
+
+    auto header = reinterpret_cast<uchar *>(data.data());
+    qToBigEndian<quint32>(quint32(data.size() / MEMO_BLOCK_LENGTH), header);
+    qToBigEndian<quint16>(quint16(MEMO_BLOCK_LENGTH), header + 6);
+
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+
+QByteArray memoField(qint32 index)
+{
+    QByteArray data(4, '\0');
+    qToLittleEndian<qint32>(index, reinterpret_cast<uchar *>(data.data()));
+    return data;
+}
+
+} // namespace
+
+
+class tst_QDbfTable : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void rangeMinimumLongerThanField_data();
+    void rangeMinimumLongerThanField();
+    void rangeMaximumLongerThanField();
+    void memoAfterCodepageChange();
+    void rejectedRecordKeepsMemo_data();
+    void rejectedRecordKeepsMemo();
+
+private:
+    QString filePath(const QString &fileName) const;
+    bool writeNamesTable(const QString &fileName);
+    QStringList matchingNames(const QString &fileName, const QVariant &minimum, const QVariant &maximum);
+
+    QString m_dataPath;
+};
+
+
+void tst_QDbfTable::initTestCase()
+{
+    m_dataPath = QString(QLatin1String("%1/tst_qdbftable-%2")).arg(QDir::tempPath()).arg(QCoreApplication::applicationPid());
+    QVERIFY(QDir().mkpath(m_dataPath));
+}
+
+
+void tst_QDbfTable::cleanupTestCase()
+{
+    QDir dir(m_dataPath);
+    const auto &fileNames = dir.entryList(QDir::Files);
+    for (auto i = 0; i < fileNames.size(); ++i) {
+        dir.remove(fileNames.at(i));
+    }
+    QDir().rmdir(m_dataPath);
+}
+
+
+QString tst_QDbfTable::filePath(const QString &fileName) const
+{
+    return QString(QLatin1String("%1/%2")).arg(m_dataPath, fileName);
+}
+
+
+bool tst_QDbfTable::writeNamesTable(const QString &fileName)
+{
+    QVector<Field> fields;
+    fields.append(Field{ "NAME", 'C', 4, 0 });
+
+    QVector<QByteArray> records;
+    records << "ABC " << "ABCC" << "ABCD" << "ABCE";
+
+    return writeTable(fileName, 0x03, fields, records);
+}
+
+
+QStringList tst_QDbfTable::matchingNames(const QString &fileName, const QVariant &minimum, const QVariant &maximum)
+{
+    QStringList names;
+
+    QDbfTable table;
+    if (!table.open(fileName) || !table.setFilter(QDbfFilter().addRange(0, minimum, maximum))) {
+        return names;
+    }
+
+    while (table.nextMatching()) {
+        names.append(table.value(0).toString().trimmed());
+    }
+
+    return names;
+}
+
+
+void tst_QDbfTable::rangeMinimumLongerThanField_data()
+{
+    QTest::addColumn<QString>("minimum");
+    QTest::addColumn<QStringList>("names");
+
+    QTest::newRow("greater tail") << QString(QLatin1String("ABCDX"))
+                                  << (QStringList() << QLatin1String("ABCE"));
+    QTest::newRow("blank tail") << QString(QLatin1String("ABCD  "))
+                                << (QStringList() << QLatin1String("ABCD") << QLatin1String("ABCE"));
+}
+
+
+// A value equal to the first field length characters of the minimum is below it
+void tst_QDbfTable::rangeMinimumLongerThanField()
+{
+    QFETCH(QString, minimum);
+    QFETCH(QStringList, names);
+
+    const auto &fileName = filePath(QLatin1String("names.dbf"));
+    QVERIFY(writeNamesTable(fileName));
+    QCOMPARE(matchingNames(fileName, minimum, QVariant()), names);
+}
+
+
+// A maximum is still compared inclusively against its first field length characters
+void tst_QDbfTable::rangeMaximumLongerThanField()
+{
+    const auto &fileName = filePath(QLatin1String("names.dbf"));
+    QVERIFY(writeNamesTable(fileName));
+    QCOMPARE(matchingNames(fileName, QVariant(), QString(QLatin1String("ABCDX"))),
+             QStringList() << QLatin1String("ABC") << QLatin1String("ABCC") << QLatin1String("ABCD"));
+}
+
+
+// Memos read before the codepage changed are decoded again with the new codec
+void tst_QDbfTable::memoAfterCodepageChange()
+{
+    QVector<Field> fields;
+    fields.append(Field{ "NOTES", 'M', 4, 0 });
+
+    QVector<qint32> indexes;
+    QVERIFY(writeFoxProMemo(filePath(QLatin1String("codepage.fpt")), QVector<QByteArray>() << "caf\xE9", indexes));
+    QVERIFY(writeTable(filePath(QLatin1String("codepage.dbf")), 0x30, fields,
+                       QVector<QByteArray>() << memoField(indexes.at(0))));
+
+    QDbfTable table;
+    QVERIFY(table.open(filePath(QLatin1String("codepage.dbf")), QDbfTable::ReadWrite));
+    QVERIFY(table.first());
+    QCOMPARE(table.value(0).toString(), QString::fromUtf8("caf\xC3\xA9"));
+    QCOMPARE(table.memo(0).toString(), QString::fromUtf8("caf\xC3\xA9"));
+
+    QVERIFY(table.setCodepage(QDbfTable::IBM866));
+    QCOMPARE(table.value(0).toString(), QString::fromUtf8("caf\xD1\x89"));
+    QCOMPARE(table.memo(0).toString(), QString::fromUtf8("caf\xD1\x89"));
+}
+
+
+void tst_QDbfTable::rejectedRecordKeepsMemo_data()
+{
+    QTest::addColumn<QString>("replacement");
+
+    QTest::newRow("fits the old blocks") << QString(QLatin1String("replaced"));
+    QTest::newRow("needs new blocks") << QString(3 * MEMO_BLOCK_LENGTH, QLatin1Char('r'));
+}
+
+
+// A record with a valid new memo and an invalid later value is rejected as a whole, the old
+// memo is neither overwritten nor freed, so a memo added afterwards gets blocks of its own
+void tst_QDbfTable::rejectedRecordKeepsMemo()
+{
+    QFETCH(QString, replacement);
+
+    QVector<Field> fields;
+    fields.append(Field{ "NOTES", 'M', 4, 0 });
+    fields.append(Field{ "STAMP", 'T', 8, 0 });
+
+    QVector<qint32> indexes;
+    QVERIFY(writeFoxProMemo(filePath(QLatin1String("memos.fpt")),
+                            QVector<QByteArray>() << "first" << "second", indexes));
+    QVERIFY(writeTable(filePath(QLatin1String("memos.dbf")), 0x30, fields,
+                       QVector<QByteArray>() << memoField(indexes.at(0)) + QByteArray(8, '\0')
+                                             << memoField(indexes.at(1)) + QByteArray(8, '\0')));
+
+    QDbfTable table;
+    QVERIFY(table.open(filePath(QLatin1String("memos.dbf")), QDbfTable::ReadWrite));
+    table.setMemoCacheSize(0);
+
+    QVERIFY(table.first());
+    auto record = table.record();
+    record.setValue(0, replacement);
+    record.setValue(1, QDateTime());
+    QVERIFY(!table.setRecord(record));
+    QCOMPARE(table.error(), QDbfTable::InvalidValue);
+
+    record.setValue(0, QString(QLatin1String("third")));
+    record.setValue(1, QDateTime(QDate(2020, 1, 2), QTime(3, 4, 5)));
+    QVERIFY(table.addRecord(record));
+    table.close();
+
+    QVERIFY(table.open(filePath(QLatin1String("memos.dbf"))));
+    QCOMPARE(table.size(), 3);
+    QVERIFY(table.seek(0));
+    QCOMPARE(table.value(0).toString(), QString(QLatin1String("first")));
+    QVERIFY(table.seek(1));
+    QCOMPARE(table.value(0).toString(), QString(QLatin1String("second")));
+    QVERIFY(table.seek(2));
+    QCOMPARE(table.value(0).toString(), QString(QLatin1String("third")));
+}
+
+
+QTEST_APPLESS_MAIN(tst_QDbfTable)
+
+#include "tst_qdbftable.moc"